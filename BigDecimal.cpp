@@ -5,490 +5,2802 @@
 #include <utility>
 #include <cmath>
 #include <compare>
+#include <numeric>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <bit>
+#include <cfloat>
+#include <cstdlib>
+#include <cstdio>
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define BIGDECIMAL_X86_KERNELS
+#endif
 
-BigDecimal::BigDecimal(long long i) {
-	sign = i >= 0;
-	while (i != 0) {
-		digits.push_back(static_cast<char>('0' + std::abs(i % 10)));
-		i /= 10;
+namespace {
+	//Reports an error by throwing E, or where exceptions are turned off (-fno-exceptions), by printing the message
+	//and aborting; the non-throwing API (from_chars, parse and the try functions) never gets here
+	template<typename E>
+	[[noreturn]] void fail(const std::string& message) {
+#ifdef __cpp_exceptions
+		throw E(message);
+#else
+		std::fprintf(stderr, "BigDecimal: %s\n", message.c_str());
+		std::abort();
+#endif
 	}
-	normalize();
-}
-
-BigDecimal::BigDecimal(long i) : BigDecimal(static_cast<long long>(i)) {}
-BigDecimal::BigDecimal(int i) : BigDecimal(static_cast<long long>(i)) {}
-BigDecimal::BigDecimal(short i) : BigDecimal(static_cast<long long>(i)) {}
-BigDecimal::BigDecimal(char i) : BigDecimal(static_cast<long long>(i)) {}
-BigDecimal::BigDecimal(double d, int precision) : BigDecimal(static_cast<long double>(d), precision) {}
-BigDecimal::BigDecimal(float d, int precision) : BigDecimal(static_cast<long double>(d), precision) {}
 
-BigDecimal::BigDecimal(long double d, int precision) {
-	std::stringstream stream{};
-	stream << std::scientific << std::setprecision(precision) << d;
-	constructFromChars(stream.str());
+	void requireFinite(const BigDecimal& x) {
+		if (!x.isFinite()) {
+			fail<std::domain_error>("argument must be finite");
+		}
+	}
 }
 
-BigDecimal::BigDecimal(const std::string& str) {
-	constructFromChars(str);
+template<typename E>
+void BigDecimal::raise(std::string_view message) {
+	fail<E>(std::string(message));
 }
 
-BigDecimal::BigDecimal(const char* chars) {
-	constructFromChars(std::string(chars));
-}
+template void BigDecimal::raise<std::invalid_argument>(std::string_view);
+template void BigDecimal::raise<std::out_of_range>(std::string_view);
+template void BigDecimal::raise<std::domain_error>(std::string_view);
+template void BigDecimal::raise<std::logic_error>(std::string_view);
 
-void BigDecimal::constructFromChars(std::string str) {
-	if (str.empty()) {
+BigDecimal::BigDecimal(double d, int precision) {
+	precision = std::max(precision, 0);
+#ifdef __cpp_lib_to_chars
+	//to_chars scales the significand in fixed width integers and only generates the digits asked for, correctly
+	//rounded, so it's much cheaper than expanding the exact value just to round most of it away
+	if (std::isfinite(d) && precision < 100) {
+		char buffer[128];
+		auto end = std::to_chars(buffer, buffer + sizeof(buffer), d, std::chars_format::scientific, precision).ptr;
+		from_chars(buffer, end, *this);
 		return;
 	}
-	auto begin = str.begin();
-	auto end = str.end();
-	if (str.at(0) == '-' || str.at(0) == '+') {
-		sign = str.at(0) == '+';
-		begin++;
-		if (begin == end) {
-			throw std::invalid_argument(std::string("\"") + str + "\" is not a valid decimal");
-		}
-	}
-	auto pointIter = std::find(begin, end, '.');
-	auto eIter = std::find_if(begin, end, [](char c) {return c == 'e' || c == 'E'; });
-	if (eIter < pointIter && pointIter != end) {
-		throw std::invalid_argument(std::string("\"") + str + "\" is not a valid decimal");
-	}
-	if (eIter != end) {
-		exponent = std::stoi(std::string(eIter + 1, end));
-		end = eIter;
-	}
-	if (!(pointIter == end || pointIter > eIter)) {
-		//Remove trailing zeroes after decimal point
-		while (*(end - 1) == '0')
-			--end;
-		exponent -= static_cast<int>(end - pointIter - 1);
-		end = std::shift_left(pointIter, end, 1);
-	}
-    if(end == begin) {
-        throw std::invalid_argument(std::string("\"") + str + "\" is not a valid decimal");
-    }
-	auto iter = end - 1;
-	while (true) {
-		if (*iter < '0' || *iter > '9') throw std::invalid_argument(std::string("\"") + str + "\" is not a valid decimal");
-		digits.push_back(*iter);
-		if (iter == begin) break;
-		iter--;
+#endif
+	*this = exact(d).round(precision + 1);
+}
+
+//Every float is exactly a double, so rounding either gives the same digits
+BigDecimal::BigDecimal(float d, int precision) : BigDecimal(static_cast<double>(d), precision) {}
+
+namespace {
+	//|d| == mantissa * 2^exponent with an integer mantissa, read straight off the significand and exponent fields.
+	//ulpExponent is the exponent of the last significand bit, which subnormals share with the smallest normals
+	struct BinaryValue {
+		BigDecimal mantissa;
+		int exponent;
+		int ulpExponent;
+		bool evenMantissa;
+		//A power of two with a normal predecessor has half the gap below it that it has above
+		bool narrowBelow;
+	};
+
+	//2^power, exactly; 0.5 is a single digit base, so negative powers are 5^-power with the exponent scaled
+	BigDecimal powerOfTwo(int power) {
+		return power >= 0 ? pow(BigDecimal{2}, power) : pow(BigDecimal{"0.5"}, -static_cast<int64_t>(power));
 	}
-	normalize();
+
+	template<std::floating_point T>
+	BinaryValue decompose(T d) {
+		if (!std::isfinite(d)) {
+			fail<std::invalid_argument>("infinities and NaNs have no decimal value");
+		}
+		using Limits = std::numeric_limits<T>;
+		int binaryExponent = 0;
+		T fraction = std::frexp(std::fabs(d), &binaryExponent);
+		BinaryValue result{{}, 0, std::max(binaryExponent, Limits::min_exponent) - Limits::digits, true, false};
+		result.evenMantissa = fraction == 0 || std::fmod(std::ldexp(std::fabs(d), -result.ulpExponent), T{2}) == 0;
+		result.narrowBelow = fraction == T{0.5} && binaryExponent > Limits::min_exponent;
+		//The significand is taken 32 bits at a time, so this works whatever the type's width is
+		while (fraction != 0) {
+			fraction = std::ldexp(fraction, 32);
+			T whole = std::floor(fraction);
+			result.mantissa = result.mantissa * BigDecimal{int64_t{1} << 32} + BigDecimal{static_cast<long long>(whole)};
+			fraction -= whole;
+			binaryExponent -= 32;
+		}
+		result.exponent = binaryExponent;
+		return result;
+	}
+}
+
+BigDecimal::BigDecimal(long double d, int precision) {
+	//Rounded from the exact binary value, as long double's layout varies too much between targets to rely on to_chars
+	*this = exact(d).round(std::max(precision, 0) + 1);
+}
+
+BigDecimal BigDecimal::exact(long double d) {
+	BinaryValue binary = decompose(d);
+	BigDecimal result = binary.mantissa * powerOfTwo(binary.exponent);
+	result.sign = result.digits.empty() || !std::signbit(d);
+	return result;
 }
 
-void BigDecimal::normalize() {
-	//Digits are stored least significant to most, so leading zeroes are significant, trailing zeroes are not
-	//Remove trailing zeroes
-	for (int i = static_cast<int>(digits.size()) - 1; i >= 0 && digits.at(i) == '0'; i--) {
-		digits.pop_back();
+template<std::floating_point T>
+BigDecimal BigDecimal::shortestOf(T d) {
+#ifdef __cpp_lib_to_chars
+	//Ryu in libstdc++ and MSVC, which finds the digits in fixed width integers
+	if (!std::is_same_v<T, long double> && std::isfinite(d)) {
+		char buffer[64];
+		auto end = std::to_chars(buffer, buffer + sizeof(buffer), d, std::chars_format::scientific).ptr;
+		BigDecimal result{};
+		from_chars(buffer, end, result);
+		return result;
 	}
-	//Ensure equality at 0
-	if (digits.empty()) {
-		sign = true;
-		exponent = 0;
-		return;
+#endif
+	BinaryValue binary = decompose(d);
+	if (binary.mantissa.digits.empty()) {
+		return {};
 	}
-	//Remove leading zeroes
-	for (auto iter = digits.begin(); iter != digits.end() && *iter == '0'; iter = digits.erase(iter)) {
-		exponent++;
+	BigDecimal value = binary.mantissa * powerOfTwo(binary.exponent);
+	//Anything strictly between the midpoints to the neighbours reads back as d, and so do the midpoints themselves
+	//when d's mantissa is even, since reading rounds half to even
+	BigDecimal above = value + powerOfTwo(binary.ulpExponent - 1);
+	BigDecimal below = value - powerOfTwo(binary.ulpExponent - (binary.narrowBelow ? 2 : 1));
+	auto inside = [&](const BigDecimal& candidate) {
+		return binary.evenMantissa ? below <= candidate && candidate <= above : below < candidate && candidate < above;
+	};
+	int lead = static_cast<int>(value.digits.size()) + value.exponent;
+	for (int precision = 1;; precision++) {
+		//The nearest precision digit value, then the one on the other side of value
+		BigDecimal nearest = value.rounded(precision);
+		if (inside(nearest)) {
+			nearest.sign = !std::signbit(d);
+			return nearest;
+		}
+		BigDecimal other = value;
+		other.truncate(lead - precision);
+		if (other == nearest) {
+			other += powerOfTen(lead - precision);
+		}
+		if (inside(other)) {
+			other.sign = !std::signbit(d);
+			return other;
+		}
 	}
 }
 
+BigDecimal BigDecimal::shortest(float d) {
+	return shortestOf(d);
+}
+
+BigDecimal BigDecimal::shortest(double d) {
+	return shortestOf(d);
+}
+
+BigDecimal BigDecimal::shortest(long double d) {
+	return shortestOf(d);
+}
+
 namespace {
-	long long longLongE(char digit, int pos) {
-		long long result = digit - '0';
-		if (result == 0) return 0;
-		for (int i = 0; i < pos; i++) {
-			result *= 10;
-		}
+	BigDecimal::ParseResult parseFailure(BigDecimal::ParseError error) {
+#ifdef __cpp_lib_expected
+		return std::unexpected(error);
+#else
+		return BigDecimal::ParseResult{error};
+#endif
+	}
+}
+
+BigDecimal::ParseResult BigDecimal::parse(std::string_view chars) {
+	BigDecimal result{};
+	if (chars.empty()) {
 		return result;
 	}
+	const char* last = chars.data() + chars.size();
+	auto [end, error] = from_chars(chars.data(), last, result);
+	if (error == std::errc::result_out_of_range) {
+		return parseFailure(ParseError::exponentOutOfRange);
+	}
+	if (error != std::errc{} || end != last) {
+		return parseFailure(ParseError::invalidSyntax);
+	}
+	return result;
 }
 
-int64_t BigDecimal::toInt64() {
-	if (digits.size() + exponent > 19) {
-		if (sign)
-			throw std::overflow_error("BigDecimal can't fit in long long");
-		else throw std::underflow_error("BigDecimal can't fit in long long");
+namespace {
+	const char* skipDigitsScalar(const char* first, const char* last) {
+		while (first != last && *first >= '0' && *first <= '9') {
+			first++;
+		}
+		return first;
 	}
-	long long result = 0;
-	int pos = exponent;
-	if (sign) {
-		for (char digit : digits) {
-			if (pos >= 0) {
-				long long toAdd = longLongE(digit, pos);
-				if (toAdd > std::numeric_limits<long long>::max() - result) {
-					throw std::overflow_error("BigDecimal can't fit in long long");
-				}
-				else result += toAdd;
+
+#ifdef BIGDECIMAL_X86_KERNELS
+	//SSE2 is part of x86-64, so this one needs no check. The compares are signed, so bytes at or above 0x80
+	//fail the '0' - 1 test just like other non-digits
+	const char* skipDigitsSse2(const char* first, const char* last) {
+		const __m128i belowZero = _mm_set1_epi8('0' - 1);
+		const __m128i aboveNine = _mm_set1_epi8('9' + 1);
+		for (; last - first >= 16; first += 16) {
+			__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+			__m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(chunk, belowZero), _mm_cmplt_epi8(chunk, aboveNine));
+			auto mask = static_cast<uint32_t>(_mm_movemask_epi8(isDigit));
+			if (mask != 0xFFFF) {
+				return first + std::countr_one(mask);
 			}
-			pos++;
 		}
+		return skipDigitsScalar(first, last);
 	}
-	else {
-		for (char digit : digits) {
-			if (pos >= 0) {
-				long long toSubtract = longLongE(digit, pos);
-				if (-1 * toSubtract < std::numeric_limits<long long>::min() - result) {
-					throw std::underflow_error("BigDecimal can't fit in long long");
-				}
-				else result -= toSubtract;
+
+	__attribute__((target("avx2")))
+	const char* skipDigitsAvx2(const char* first, const char* last) {
+		const __m256i belowZero = _mm256_set1_epi8('0' - 1);
+		const __m256i aboveNine = _mm256_set1_epi8('9' + 1);
+		for (; last - first >= 32; first += 32) {
+			__m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+			__m256i isDigit = _mm256_and_si256(_mm256_cmpgt_epi8(chunk, belowZero), _mm256_cmpgt_epi8(aboveNine, chunk));
+			auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(isDigit));
+			if (mask != 0xFFFFFFFF) {
+				return first + std::countr_one(mask);
 			}
-			pos++;
 		}
+		return skipDigitsSse2(first, last);
 	}
-	return result;
+#endif
 }
 
-long double BigDecimal::toLongDouble() {
-	int pos = exponent;
-	long double result = 0;
-	for (char digit : digits) {
-		result += (digit - '0') * std::pow(10, pos);
-		pos++;
-	}
-	return result;
+const char* BigDecimal::skipDigits(const char* first, const char* last) {
+#ifdef BIGDECIMAL_X86_KERNELS
+	static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+	return hasAvx2 ? skipDigitsAvx2(first, last) : skipDigitsSse2(first, last);
+#else
+	return skipDigitsScalar(first, last);
+#endif
 }
 
-std::string BigDecimal::toString() const {
+template<typename T>
+std::optional<T> BigDecimal::toInteger(Rounding mode) const {
+	if (kind != Kind::finite) {
+		return std::nullopt;
+	}
+	//The unsigned type as wide as T
+#ifdef __SIZEOF_INT128__
+	using Magnitude = std::conditional_t<(sizeof(T) > 8), unsigned __int128, uint64_t>;
+#else
+	using Magnitude = uint64_t;
+#endif
+	constexpr bool isSigned = static_cast<T>(-1) < 0;
 	if (digits.empty()) {
-		return "0";
+		return T{0};
 	}
-	std::string result{};
-	int offset = 0;
-	if (!sign) {
-		result += "-";
-		offset = 1;
+	auto count = static_cast<int64_t>(digits.size());
+	int64_t lead = int64_t{exponent} + count - 1;
+	//No supported type holds 10^39, so anything that large is out before any digits are read
+	if (lead >= 39) {
+		return std::nullopt;
 	}
-	result += std::string_view(digits.begin(), digits.end());
-	std::reverse(result.begin() + offset, result.end());
-	if (exponent < 0) {
-		int pointPos = std::abs(exponent);
-		if (pointPos == digits.size()) {
-			result.insert(offset, "0.");
+	constexpr Magnitude maxMagnitude = std::numeric_limits<Magnitude>::max();
+	Magnitude magnitude = 0;
+	auto append = [&magnitude](Magnitude digit) {
+		if (magnitude > (maxMagnitude - digit) / 10) {
+			return false;
 		}
-		else if (pointPos > digits.size()) {
-            if(offset + 1 != result.size())
-			    result.insert(offset + 1, ".");
-			result += "e-";
-			result += std::to_string(pointPos - digits.size() + 1);
+		magnitude = magnitude * 10 + digit;
+		return true;
+	};
+	//Only the digits at or above 10^0; those below only decide the rounding
+	for (int64_t position = lead; position >= 0; position--) {
+		int64_t index = position - exponent;
+		if (!append(index >= 0 ? static_cast<Magnitude>(digits[static_cast<size_t>(index)] - '0') : 0)) {
+			return std::nullopt;
 		}
-		else {
-			result.insert(offset + digits.size() - pointPos, ".");
+	}
+	if (exponent < 0) {
+		//The digit at 10^-1, and whether anything non-zero lies below it; the lowest digit never is zero
+		int64_t halfIndex = -1 - exponent;
+		int half = halfIndex < count ? digits[static_cast<size_t>(halfIndex)] - '0' : 0;
+		bool below = exponent < -1;
+		bool awayFromZero = false;
+		switch (mode) {
+		case Rounding::towardZero:
+			break;
+		case Rounding::floor:
+			awayFromZero = !sign;
+			break;
+		case Rounding::ceiling:
+			awayFromZero = sign;
+			break;
+		case Rounding::halfEven:
+			awayFromZero = half > 5 || (half == 5 && (below || magnitude % 2 == 1));
+			break;
+		case Rounding::halfAwayFromZero:
+			awayFromZero = half >= 5;
+			break;
+		}
+		if (awayFromZero) {
+			if (magnitude == maxMagnitude) {
+				return std::nullopt;
+			}
+			magnitude++;
 		}
 	}
-	else if (exponent != 0) {
-		result += "e+";
-		result += std::to_string(exponent);
+	constexpr Magnitude maxPositive = isSigned ? maxMagnitude >> 1 : maxMagnitude;
+	if (sign || magnitude == 0) {
+		return magnitude > maxPositive ? std::nullopt : std::optional<T>{static_cast<T>(magnitude)};
 	}
-	return result;
-}
-
-BigDecimal& BigDecimal::operator+=(const BigDecimal& bd) {
-	if (this->sign == bd.sign) {
-		doAdd(bd);
+	if constexpr (!isSigned) {
+		return std::nullopt;
 	}
 	else {
-		doSubtract(bd);
+		//-(max + 1) is the one value whose magnitude doesn't fit in T, so negate it as an unsigned value
+		if (magnitude > maxPositive + 1) {
+			return std::nullopt;
+		}
+		return static_cast<T>(Magnitude{0} - magnitude);
 	}
-	return *this;
 }
 
-BigDecimal& BigDecimal::operator-=(const BigDecimal& bd) {
-	if (this->sign == bd.sign) {
-		doSubtract(bd);
-	}
-	else {
-		doAdd(bd);
+std::optional<int64_t> BigDecimal::tryToInt64(Rounding mode) const {
+	return toInteger<int64_t>(mode);
+}
+
+std::optional<uint64_t> BigDecimal::tryToUint64(Rounding mode) const {
+	return toInteger<uint64_t>(mode);
+}
+
+int64_t BigDecimal::toInt64(Rounding mode) const {
+	std::optional<int64_t> result = tryToInt64(mode);
+	if (!result) {
+		if (sign) {
+			fail<std::overflow_error>("BigDecimal can't fit in long long");
+		}
+		fail<std::underflow_error>("BigDecimal can't fit in long long");
 	}
-	return *this;
+	return *result;
 }
 
-BigDecimal BigDecimal::singleDigitMultiply(BigDecimal bd, int digit) {
-	bd.sign = true;
-	bd.exponent = 0;
-	int carry = 0;
-	for (char& c : bd.digits) {
-		int elem = (c - '0') * digit + carry;
-		c = static_cast<char>(elem % 10 + '0');
-		carry = elem / 10;
+uint64_t BigDecimal::toUint64(Rounding mode) const {
+	std::optional<uint64_t> result = tryToUint64(mode);
+	if (!result) {
+		if (sign) {
+			fail<std::overflow_error>("BigDecimal can't fit in unsigned long long");
+		}
+		fail<std::underflow_error>("BigDecimal can't fit in unsigned long long");
 	}
-	for (; carry > 0; carry /= 10) {
-		bd.digits.push_back(static_cast<char>(carry % 10 + '0'));
+	return *result;
+}
+
+#ifdef __SIZEOF_INT128__
+std::optional<__int128> BigDecimal::tryToInt128(Rounding mode) const {
+	return toInteger<__int128>(mode);
+}
+
+__int128 BigDecimal::toInt128(Rounding mode) const {
+	std::optional<__int128> result = tryToInt128(mode);
+	if (!result) {
+		if (sign) {
+			fail<std::overflow_error>("BigDecimal can't fit in __int128");
+		}
+		fail<std::underflow_error>("BigDecimal can't fit in __int128");
 	}
-	bd.normalize();
-	return bd;
+	return *result;
 }
+#endif
 
-BigDecimal& BigDecimal::operator*=(const BigDecimal& bd) {
-	bool newSign = sign == bd.sign;
-	int newExponent = exponent + bd.exponent;
-	const BigDecimal* bd1;
-	const std::vector<char>* d2;
-	if (digits.size() > bd.digits.size()) {
-		bd1 = this;
-		d2 = &bd.digits;
+template<std::floating_point T>
+T BigDecimal::toFloatingPoint() const {
+	using Limits = std::numeric_limits<T>;
+	if (kind == Kind::nan) {
+		return Limits::quiet_NaN();
 	}
-	else {
-		bd1 = &bd;
-		d2 = &digits;
+	if (kind == Kind::infinity) {
+		return sign ? Limits::infinity() : -Limits::infinity();
 	}
-	if (d2->empty()) {
-		digits.clear();
-		normalize();
-		return *this;
+	if (digits.empty()) {
+		return 0;
 	}
-	BigDecimal total = 0;
-	for (int i = 0; i < d2->size(); i++) {
-		BigDecimal row = singleDigitMultiply(*bd1, d2->at(i) - '0');
-		row.exponent += i;
-		total += row;
+	T signedOne = sign ? 1 : -1;
+	auto count = static_cast<int64_t>(digits.size());
+	int64_t lead = int64_t{exponent} + count - 1;
+	if (lead > Limits::max_exponent10) {
+		return signedOne * Limits::infinity();
+	}
+	if (lead < Limits::min_exponent10 - Limits::digits10 - 4) {
+		return signedOne * 0;
+	}
+	//Clinger's fast path: a significand and a power of ten that are both exact give a correctly rounded
+	//product or quotient. Needs arithmetic done in T itself, which x87 only guarantees for long double
+	constexpr int exactPowers = Limits::digits >= 64 ? 27 : Limits::digits >= 53 ? 22 : 10;
+	if ((FLT_EVAL_METHOD == 0 || std::is_same_v<T, long double>) && count <= 19 && std::abs(exponent) <= exactPowers) {
+		uint64_t significand = 0;
+		for (auto digit = digits.rbegin(); digit != digits.rend(); digit++) {
+			significand = significand * 10 + static_cast<uint64_t>(*digit - '0');
+		}
+		if (significand >> std::min(Limits::digits, 63) == 0) {
+			T power = 1;
+			for (int i = 0; i < std::abs(exponent); i++) {
+				power *= 10;
+			}
+			auto value = static_cast<T>(significand);
+			return signedOne * (exponent < 0 ? value / power : value * power);
+		}
+	}
+	//Otherwise the digits go to the standard library's correctly rounded parser as an integer and an exponent, so no
+	//locale's decimal point gets involved. Digits past the most that can decide a rounding (halfway points between
+	//subnormals) only matter for being non-zero; as the lowest digit never is, a single 1 stands in for them
+	constexpr auto keep = static_cast<int64_t>((Limits::digits - Limits::min_exponent + 1) * 0.69897 + (Limits::digits + 1) * 0.30103 + 2);
+	int64_t written = std::min(count, keep);
+	char stackBuffer[128];
+	std::vector<char> heapBuffer;
+	char* buffer = stackBuffer;
+	if (written + 32 > static_cast<int64_t>(sizeof(stackBuffer))) {
+		heapBuffer.resize(static_cast<size_t>(written + 32));
+		buffer = heapBuffer.data();
+	}
+	char* out = buffer;
+	if (!sign) {
+		*out++ = '-';
+	}
+	out = std::copy(digits.rbegin(), digits.rbegin() + written, out);
+	int64_t scale = exponent + (count - written);
+	if (written < count) {
+		*out++ = '1';
+		scale--;
+	}
+	*out++ = 'e';
+	out = std::to_chars(out, buffer + written + 31, scale).ptr;
+	*out = '\0';
+	if constexpr (std::is_same_v<T, long double>) {
+		//libstdc++'s long double from_chars reports subnormal results as out of range, so this goes to strtold directly
+		return std::strtold(buffer, nullptr);
+	}
+	else {
+#ifdef __cpp_lib_to_chars
+		T result{};
+		if (std::from_chars(buffer, out, result).ec == std::errc::result_out_of_range) {
+			return signedOne * (lead > 0 ? Limits::infinity() : 0);
+		}
+		return result;
+#else
+		if constexpr (std::is_same_v<T, float>) {
+			return std::strtof(buffer, nullptr);
+		}
+		else {
+			return std::strtod(buffer, nullptr);
+		}
+#endif
 	}
-	*this = total;
-	sign = newSign;
-	exponent = newExponent + total.exponent;
-	normalize();
-	return *this;
 }
 
-//Dividing in decimal is quite slow; probably the slowest operation implemented
-BigDecimal& BigDecimal::operator/=(BigDecimal bd) {
-	BigDecimal result{};
-	BigDecimal remainder{};
-    int exponentResult = exponent - bd.exponent;
-    bd.exponent = 0;
-	int maxDigits = static_cast<int>(std::max(digits.size(), bd.digits.size())) + 20;
-	//Long division starts with the most significant digit, so need to iterate in reverse
-	int i = static_cast<int>(digits.size()) - 1;
-	for (; i >= 0; i--) {
-		char c = digits[i];
-		remainder = remainder * 10 + (c - '0');
-		BigDecimal bdCpy = bd;
-		BigDecimal mult = 0;
-		while (bdCpy <= remainder) {
-			bdCpy += bd;
-			++mult;
-		}
-		bdCpy -= bd;
-		remainder -= bdCpy;
-		mult.exponent = i;
-		result += mult;
-	}
-	while (result.digits.size() < maxDigits && remainder != 0) {
-		remainder *= 10;
-		BigDecimal bdCpy = bd;
-		BigDecimal mult = 0;
-		while (bdCpy <= remainder) {
-			bdCpy += bd;
-			++mult;
-		}
-		bdCpy -= bd;
-		remainder -= bdCpy;
-		mult.exponent = i;
-		result += mult;
-		i--;
-	}
-	result.exponent += exponentResult;
-	*this = result;
-	normalize();
-	return *this;
+double BigDecimal::toDouble() const {
+	return toFloatingPoint<double>();
 }
 
-BigDecimal& BigDecimal::operator%=(BigDecimal bd) {
-    bd.sign = true;
-    bool signTemp = sign;
-    sign = true;
-    std::strong_ordering cmp = *this <=> bd;
-    if(cmp == std::strong_ordering::less) {
-        sign = signTemp;
-        return *this;
-    }
-    else if(cmp == std::strong_ordering::equal) {
-        *this = BigDecimal{};
-        return *this;
-    }
-	BigDecimal remainder{};
-	int exponentChange = 0;
-	if (exponent > 0) {
-		digits.insert(digits.begin(), exponent, '0');
+float BigDecimal::toFloat() const {
+	return toFloatingPoint<float>();
+}
+
+long double BigDecimal::toLongDouble() const {
+	return toFloatingPoint<long double>();
+}
+
+namespace {
+	size_t exponentDigits(int64_t exponent) {
+		size_t count = 1;
+		for (exponent = exponent < 0 ? -exponent : exponent; exponent >= 10; exponent /= 10) {
+			count++;
+		}
+		return count;
+	}
+}
+
+BigDecimal::Layout BigDecimal::layout(char type, int precision, char signMode) const {
+	Layout result{};
+	using Kind = Layout::Piece::Kind;
+	auto add = [&result](Kind kind, int64_t first, int64_t second = 0) {
+		size_t size = kind == Kind::digits ? static_cast<size_t>(second - first) :
+			kind == Kind::zeroes ? static_cast<size_t>(first) :
+			kind == Kind::character ? 1 : 2 + exponentDigits(first);
+		if (size != 0) {
+			result.pieces[result.count++] = {kind, first, second};
+			result.size += size;
+		}
+	};
+	//Rounding never copies the digits: the rounded value is the first kept digits of this one, most significant
+	//first, then possibly one more digit that rounding up produced, and exp is the exponent of its last digit
+	auto kept = static_cast<int64_t>(digits.size());
+	char bumped = '\0';
+	int64_t exp = exponent;
+	bool negative = !sign;
+	auto digitAt = [this](int64_t i) { return digits[digits.size() - 1 - static_cast<size_t>(i)]; };
+	if (precision >= 0 && kind == BigDecimal::Kind::finite && kept != 0) {
+		int64_t count = kept;
+		//'f' keeps precision digits after the point, which is a number of significant digits that depends on the magnitude
+		int64_t significant = type == 'e' || type == 'n' ? int64_t{precision} + 1 : type == 'f' ? exp + count + precision : std::max(precision, 1);
+		if (significant <= 0) {
+			//Below half a unit in the last place rounds to zero; exactly half rounds to zero too, as it's even
+			bool roundUp = significant == 0 && (digitAt(0) > '5' || (digitAt(0) == '5' && count > 1));
+			kept = 0;
+			bumped = roundUp ? '1' : '\0';
+			exp = -precision;
+			negative = negative && roundUp;
+		}
+		else if (significant < count) {
+			char first = digitAt(significant);
+			bool roundUp = first > '5' || (first == '5' &&
+				(significant + 1 < count || (digitAt(significant - 1) - '0') % 2 == 1));
+			exp += count - significant;
+			kept = significant;
+			//Rounding down leaves trailing zeroes to drop; rounding up turns trailing nines into more of them
+			char dropped = roundUp ? '9' : '0';
+			for (; kept > 0 && digitAt(kept - 1) == dropped; kept--) {
+				exp++;
+			}
+			if (roundUp) {
+				bumped = kept == 0 ? '1' : static_cast<char>(digitAt(kept - 1) + 1);
+				kept -= kept == 0 ? 0 : 1;
+			}
+		}
+	}
+	//The digits pieces index the rounded digits, so the bumped one has to be split off as a character
+	auto addDigits = [&](int64_t first, int64_t second) {
+		add(Kind::digits, std::min(first, kept), std::min(second, kept));
+		if (bumped != '\0' && first <= kept && kept < second) {
+			add(Kind::character, bumped);
+		}
+	};
+	int64_t count = kept + (bumped != '\0' ? 1 : 0);
+	//Exponent of the leading digit
+	int64_t lead = exp + count - 1;
+	if (negative) {
+		add(Kind::character, '-');
+	}
+	else if (signMode == '+' || signMode == ' ') {
+		add(Kind::character, signMode);
+	}
+	if (kind != BigDecimal::Kind::finite) {
+		for (char c : std::string_view{kind == BigDecimal::Kind::nan ? "nan" : "inf"}) {
+			add(Kind::character, c);
+		}
+		return result;
+	}
+	//The first whole digits, padded with zeroes, then fraction digits after the point if there are any
+	auto addMantissa = [&](int64_t whole, int64_t fraction) {
+		addDigits(0, std::min(count, whole));
+		add(Kind::zeroes, std::max<int64_t>(whole - count, 0));
+		if (fraction > 0) {
+			add(Kind::character, '.');
+			addDigits(std::min(count, whole), count);
+			add(Kind::zeroes, fraction - std::max<int64_t>(count - whole, 0));
+		}
+	};
+	if (type == 'e' || type == 'n') {
+		if (count == 0) {
+			add(Kind::character, '0');
+			if (precision > 0) {
+				add(Kind::character, '.');
+				add(Kind::zeroes, precision);
+			}
+			add(Kind::exponent, 0);
+			return result;
+		}
+		//Engineering notation keeps one to three digits before the point
+		int64_t scaled = type == 'e' ? lead : (lead >= 0 ? lead / 3 : -((-lead + 2) / 3)) * 3;
+		int64_t whole = lead - scaled + 1;
+		int64_t shown = precision >= 0 ? int64_t{precision} + 1 : count;
+		addMantissa(whole, shown - whole);
+		add(Kind::exponent, scaled);
+		return result;
+	}
+	if (type == 'f') {
+		int64_t fraction = precision >= 0 ? precision : std::max<int64_t>(-exp, 0);
+		if (count == 0 || lead < 0) {
+			add(Kind::character, '0');
+			if (fraction > 0) {
+				add(Kind::character, '.');
+				add(Kind::zeroes, count == 0 ? fraction : -lead - 1);
+				addDigits(0, count);
+				add(Kind::zeroes, count == 0 ? 0 : fraction + exp);
+			}
+			return result;
+		}
+		addMantissa(lead + 1, fraction);
+		return result;
+	}
+	if (count == 0) {
+		add(Kind::character, '0');
+	}
+	else if (exp >= 0) {
+		addDigits(0, count);
+		if (exp != 0) {
+			add(Kind::exponent, exp);
+		}
+	}
+	else if (-exp == count) {
+		add(Kind::character, '0');
+		add(Kind::character, '.');
+		addDigits(0, count);
+	}
+	else if (-exp > count) {
+		addMantissa(1, count - 1);
+		add(Kind::exponent, lead);
 	}
 	else {
-		exponentChange = std::abs(exponent);
-		bd.exponent += exponentChange;
-	}
-	exponent = 0;
-	int i = static_cast<int>(digits.size()) - 1;
-	for (; i >= 0; i--) {
-		char c = digits[i];
-		remainder = remainder * 10 + (c - '0');
-		BigDecimal bdMult = bd;
-		while (bdMult <= remainder) {
-			bdMult += bd;
-		}
-		remainder -= bdMult - bd;
-	}
-	*this = remainder;
-	exponent -= exponentChange;
-    sign = signTemp;
-	return *this;
+		addDigits(0, count + exp);
+		add(Kind::character, '.');
+		addDigits(count + exp, count);
+	}
+	return result;
 }
 
-BigDecimal& BigDecimal::operator++() {
-	return *this += 1LL;
+void BigDecimal::Formatter::rejectSpec() {
+#ifdef __cpp_lib_format
+	fail<std::format_error>("invalid format specification for BigDecimal");
+#else
+	fail<std::invalid_argument>("invalid format specification for BigDecimal");
+#endif
 }
 
-const BigDecimal BigDecimal::operator++(int) {
-	BigDecimal copy = *this;
-	*this += 1LL;
-	return copy;
+size_t BigDecimal::formattedSize(std::chars_format format) const {
+	char type = format == std::chars_format::fixed ? 'f' : format == std::chars_format::scientific ? 'e' : 'g';
+	return layout(type, -1, '-').size;
 }
 
-BigDecimal& BigDecimal::operator--() {
-	return *this -= 1LL;
+std::to_chars_result to_chars(char* first, char* last, const BigDecimal& bd, std::chars_format format) {
+	if (format != std::chars_format::general && format != std::chars_format::fixed && format != std::chars_format::scientific) {
+		return {last, std::errc::invalid_argument};
+	}
+	char type = format == std::chars_format::fixed ? 'f' : format == std::chars_format::scientific ? 'e' : 'g';
+	BigDecimal::Layout layout = bd.layout(type, -1, '-');
+	if (static_cast<size_t>(last - first) < layout.size) {
+		return {last, std::errc::value_too_large};
+	}
+	return {bd.writeLayout(first, layout), std::errc{}};
 }
 
-const BigDecimal BigDecimal::operator--(int) {
-	BigDecimal copy = *this;
-	*this -= 1LL;
-	return copy;
+std::to_chars_result to_chars(char* first, char* last, const BigDecimal& bd) {
+	return to_chars(first, last, bd, std::chars_format::general);
 }
 
-BigDecimal operator+(BigDecimal lhs, const BigDecimal& rhs) {
-	return lhs += rhs;
+std::string BigDecimal::toString() const {
+	std::string result(formattedSize(), '\0');
+	to_chars(result.data(), result.data() + result.size(), *this);
+	return result;
 }
 
-BigDecimal operator-(BigDecimal lhs, const BigDecimal& rhs) {
-	return lhs -= rhs;
+namespace {
+	//Varints are LEB128: seven bits a byte, least significant first, with the high bit set on all but the last
+	size_t varintSize(uint64_t value) {
+		size_t size = 1;
+		for (; value >= 0x80; value >>= 7) {
+			size++;
+		}
+		return size;
+	}
+
+	std::byte* writeVarint(std::byte* out, uint64_t value) {
+		for (; value >= 0x80; value >>= 7) {
+			*out++ = static_cast<std::byte>(value | 0x80);
+		}
+		*out++ = static_cast<std::byte>(value);
+		return out;
+	}
+
+	//Empty if the bytes run out first, or the value is longer than it needs to be or doesn't fit in 64 bits
+	std::optional<uint64_t> readVarint(const std::byte*& in, const std::byte* last) {
+		uint64_t value = 0;
+		for (int shift = 0; in != last && shift < 64; shift += 7) {
+			auto byte = std::to_integer<uint64_t>(*in++);
+			if (shift == 63 && byte > 1) {
+				return std::nullopt;
+			}
+			value |= (byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0) {
+				if (byte == 0 && shift != 0) {
+					return std::nullopt;
+				}
+				return value;
+			}
+		}
+		return std::nullopt;
+	}
+
+	//Three digits (0 to 999) fit in 10 bits
+	constexpr size_t groupDigits = 3;
+	constexpr size_t groupBits = 10;
+
+	size_t coefficientBytes(size_t digitCount) {
+		return ((digitCount + groupDigits - 1) / groupDigits * groupBits + 7) / 8;
+	}
 }
 
-BigDecimal operator*(BigDecimal lhs, const BigDecimal& rhs) {
-	return lhs *= rhs;
+namespace {
+	//The first byte of a key, in the order operator<=> puts the classes in
+	enum KeyClass : uint8_t { negativeInfinityKey = 1, negativeKey, zeroKey, positiveKey, infinityKey, nanKey };
+
+	//An order preserving int64_t: a header byte, 0x80 + length for non-negative values and 0x7F - length for negative
+	//ones, then the fewest big endian bytes of the value (of ~value, complemented, for negative ones)
+	size_t orderedIntSize(int64_t value) {
+		auto magnitude = static_cast<uint64_t>(value < 0 ? ~value : value);
+		return 1 + static_cast<size_t>((std::bit_width(magnitude) + 7) / 8);
+	}
+
+	std::byte* writeOrderedInt(std::byte* out, int64_t value) {
+		auto magnitude = static_cast<uint64_t>(value < 0 ? ~value : value);
+		int length = (std::bit_width(magnitude) + 7) / 8;
+		*out++ = static_cast<std::byte>(value < 0 ? 0x7F - length : 0x80 + length);
+		for (int i = length - 1; i >= 0; i--) {
+			auto byte = static_cast<uint8_t>(magnitude >> (8 * i));
+			*out++ = static_cast<std::byte>(value < 0 ? ~byte : byte);
+		}
+		return out;
+	}
+
+	//Every byte read is xored with flip first; empty unless the encoding is complete and as short as possible
+	std::optional<int64_t> readOrderedInt(const std::byte*& in, const std::byte* last, uint8_t flip) {
+		if (in == last) {
+			return std::nullopt;
+		}
+		int header = std::to_integer<uint8_t>(*in++) ^ flip;
+		bool negative = header < 0x80;
+		int length = negative ? 0x7F - header : header - 0x80;
+		if (length > 8 || last - in < length) {
+			return std::nullopt;
+		}
+		uint64_t magnitude = 0;
+		for (int i = 0; i < length; i++) {
+			auto byte = static_cast<uint8_t>(std::to_integer<uint8_t>(*in++) ^ flip);
+			magnitude = magnitude << 8 | (negative ? static_cast<uint8_t>(~byte) : byte);
+		}
+		if (static_cast<int>((std::bit_width(magnitude) + 7) / 8) != length || magnitude > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+			return std::nullopt;
+		}
+		return negative ? ~static_cast<int64_t>(magnitude) : static_cast<int64_t>(magnitude);
+	}
 }
 
-BigDecimal operator/(BigDecimal lhs, BigDecimal rhs) {
-	return lhs /= std::move(rhs);
+size_t BigDecimal::keySize() const {
+	if (kind != Kind::finite || digits.empty()) {
+		return 1;
+	}
+	return 1 + orderedIntSize(static_cast<int64_t>(exponent) + static_cast<int64_t>(digits.size())) + (digits.size() + 1) / 2;
 }
 
-BigDecimal operator%(BigDecimal lhs, BigDecimal rhs) {
-	return lhs %= std::move(rhs);
+size_t BigDecimal::encodeKey(std::span<std::byte> out) const {
+	size_t size = keySize();
+	if (out.size() < size) {
+		return 0;
+	}
+	if (kind != Kind::finite || digits.empty()) {
+		KeyClass keyClass = kind == Kind::nan ? nanKey : kind == Kind::infinity ? (sign ? infinityKey : negativeInfinityKey) : zeroKey;
+		out[0] = static_cast<std::byte>(keyClass);
+		return size;
+	}
+	out[0] = static_cast<std::byte>(sign ? positiveKey : negativeKey);
+	//The position of the leading digit orders magnitudes first, then the digits decide, most significant first
+	std::byte* iter = writeOrderedInt(out.data() + 1, static_cast<int64_t>(exponent) + static_cast<int64_t>(digits.size()));
+	//Two digits to a byte, as 2 * pair + 1, except the last byte is 2 * pair: it's even, so it ends the key, and it
+	//sorts below every continuation of the same digits. An odd count is padded with a 0
+	for (size_t i = digits.size(); i > 0; i -= std::min<size_t>(i, 2)) {
+		int pair = (digits[i - 1] - '0') * 10 + (i >= 2 ? digits[i - 2] - '0' : 0);
+		*iter++ = static_cast<std::byte>(2 * pair + (i > 2 ? 1 : 0));
+	}
+	//Negative values sort in reverse, and since no key is a prefix of another, complementing every byte does that
+	if (!sign) {
+		for (std::byte& byte : out.subspan(1, size - 1)) {
+			byte = ~byte;
+		}
+	}
+	return size;
 }
 
-std::strong_ordering operator<=>(const BigDecimal& lhs, const BigDecimal& rhs) {
-	if (lhs.sign == rhs.sign) {
-		std::strong_ordering cmp = std::strong_ordering::less;
-		int lhsMaxDigit = static_cast<int>(lhs.digits.size()) + lhs.exponent;
-		int rhsMaxDigit = static_cast<int>(rhs.digits.size()) + rhs.exponent;
-		if (lhsMaxDigit == rhsMaxDigit) {
-			std::vector<char> lhsCpy = lhs.digits;
-			std::vector<char> rhsCpy = rhs.digits;
-			std::reverse(lhsCpy.begin(), lhsCpy.end());
-			std::reverse(rhsCpy.begin(), rhsCpy.end());
-			cmp = std::lexicographical_compare_three_way(lhsCpy.begin(), lhsCpy.end(), rhsCpy.begin(), rhsCpy.end());
+size_t BigDecimal::decodeKey(std::span<const std::byte> in, BigDecimal& value) {
+	if (in.empty()) {
+		return 0;
+	}
+	const std::byte* first = in.data();
+	const std::byte* last = first + in.size();
+	const std::byte* iter = first + 1;
+	switch (std::to_integer<uint8_t>(in[0])) {
+	case negativeInfinityKey:
+		value = infinity(true);
+		return 1;
+	case zeroKey:
+		value = BigDecimal{};
+		return 1;
+	case infinityKey:
+		value = infinity();
+		return 1;
+	case nanKey:
+		value = nan();
+		return 1;
+	case positiveKey:
+	case negativeKey:
+		break;
+	default:
+		return 0;
+	}
+	bool positive = std::to_integer<uint8_t>(in[0]) == positiveKey;
+	uint8_t flip = positive ? 0x00 : 0xFF;
+	std::optional<int64_t> lead = readOrderedInt(iter, last, flip);
+	if (!lead) {
+		return 0;
+	}
+	BigDecimal result{};
+	for (bool more = true; more;) {
+		if (iter == last) {
+			return 0;
 		}
-		else {
-			cmp = lhsMaxDigit <=> rhsMaxDigit;
+		int byte = std::to_integer<uint8_t>(*iter++) ^ flip;
+		int pair = byte / 2;
+		more = byte % 2 == 1;
+		if (pair > 99 || (result.digits.empty() && pair < 10)) {
+			return 0;
 		}
-		if (lhs.sign)
-			return cmp;
-		else {
-			if (cmp == std::strong_ordering::less) return std::strong_ordering::greater;
-			else return std::strong_ordering::less;
+		result.digits.push_back(static_cast<char>('0' + pair / 10));
+		if (more || pair % 10 != 0) {
+			result.digits.push_back(static_cast<char>('0' + pair % 10));
 		}
 	}
-	else return lhs.sign <=> rhs.sign;
+	//The digits were read most significant first, and the last one must be non-zero
+	if (result.digits.back() == '0') {
+		return 0;
+	}
+	std::reverse(result.digits.begin(), result.digits.end());
+	int64_t exponent = *lead - static_cast<int64_t>(result.digits.size());
+	if (exponent > std::numeric_limits<int>::max() || exponent < std::numeric_limits<int>::min()) {
+		return 0;
+	}
+	result.sign = positive;
+	result.exponent = static_cast<int>(exponent);
+	value = std::move(result);
+	return static_cast<size_t>(iter - first);
 }
 
-std::ostream& operator<<(std::ostream& out, const BigDecimal& bd) {
-    out << bd.toString();
-    return out;
+uint64_t BigDecimal::serialTag() const {
+	if (kind != Kind::finite) {
+		uint64_t special = kind == Kind::nan ? 2 : sign ? 0 : 1;
+		return special << 2 | 2;
+	}
+	auto zigzag = exponent >= 0 ? 2 * static_cast<uint64_t>(exponent) : 2 * static_cast<uint64_t>(-static_cast<int64_t>(exponent)) - 1;
+	return zigzag << 2 | (sign ? 0 : 1);
 }
 
-std::istream& operator>>(std::istream& in, BigDecimal& bd) {
-    std::string str;
-    in >> str;
-    bd = {};
-    try {
-        bd.constructFromChars(str);
-    } catch(const std::invalid_argument& e) {
-        in.setstate(std::ios::failbit);
-    }
-    return in;
+size_t BigDecimal::serializedSize() const {
+	size_t size = varintSize(serialTag());
+	if (kind == Kind::finite) {
+		size += varintSize(digits.size()) + coefficientBytes(digits.size());
+	}
+	return size;
 }
 
-void BigDecimal::doAdd(const BigDecimal& bd) {
-	if (exponent > bd.exponent) {
-		digits.insert(digits.begin(), exponent - bd.exponent, '0');
-		exponent = bd.exponent;
+size_t BigDecimal::serialize(std::span<std::byte> out) const {
+	size_t size = serializedSize();
+	if (out.size() < size) {
+		return 0;
 	}
-	int align = bd.exponent - exponent;
-    if(align > digits.size()) {
-        digits.insert(digits.end(), align - digits.size(), '0');
-    }
-	bool carry = false;
-	int numDigits = std::min(static_cast<int>(digits.size()) - align,static_cast<int>(bd.digits.size()));
-	int i = 0;
-	for (; i < numDigits; i++) {
-		digits.at(i + align) += bd.digits.at(i) - '0' + static_cast<char>(carry);
-		if (digits.at(i + align) > '9') {
-			carry = true;
-			digits.at(i + align) -= 10;
+	std::byte* iter = writeVarint(out.data(), serialTag());
+	if (kind != Kind::finite) {
+		return size;
+	}
+	iter = writeVarint(iter, digits.size());
+	//Groups go in least significant first, like the digits, and are packed into bytes from the low bits up
+	uint32_t buffer = 0;
+	size_t bits = 0;
+	for (size_t i = 0; i < digits.size(); i += groupDigits) {
+		uint32_t group = 0;
+		for (size_t j = std::min(i + groupDigits, digits.size()); j-- > i;) {
+			group = group * 10 + static_cast<uint32_t>(digits[j] - '0');
+		}
+		buffer |= group << bits;
+		for (bits += groupBits; bits >= 8; bits -= 8) {
+			*iter++ = static_cast<std::byte>(buffer);
+			buffer >>= 8;
 		}
-		else carry = false;
 	}
-	for (; i < bd.digits.size(); i++) {
-		digits.push_back(bd.digits.at(i) + static_cast<char>(carry));
-		if (digits.at(digits.size() - 1) > '9') {
-			carry = true;
-			digits.at(digits.size() - 1) -= 10;
+	if (bits > 0) {
+		*iter++ = static_cast<std::byte>(buffer);
+	}
+	return size;
+}
+
+size_t BigDecimal::deserialize(std::span<const std::byte> in, BigDecimal& value) {
+	const std::byte* first = in.data();
+	const std::byte* last = first + in.size();
+	const std::byte* iter = first;
+	std::optional<uint64_t> tag = readVarint(iter, last);
+	if (!tag || (*tag & 3) == 3) {
+		return 0;
+	}
+	if ((*tag & 3) == 2) {
+		uint64_t special = *tag >> 2;
+		if (special > 2) {
+			return 0;
 		}
-		else carry = false;
+		value = special == 2 ? nan() : infinity(special == 1);
+		return static_cast<size_t>(iter - first);
+	}
+	uint64_t zigzag = *tag >> 2;
+	if (zigzag > std::numeric_limits<uint32_t>::max()) {
+		return 0;
+	}
+	int64_t exponent = zigzag % 2 == 0 ? static_cast<int64_t>(zigzag / 2) : -static_cast<int64_t>(zigzag / 2) - 1;
+	std::optional<uint64_t> count = readVarint(iter, last);
+	if (!count) {
+		return 0;
 	}
-	for (; carry != 0 && i < digits.size() - align; i++) {
-		digits.at(i + align) += static_cast<char>(carry);
-		if (digits.at(i + align) > '9') {
-			carry = digits.at(i + align) - '9';
-			digits.at(i + align) -= 10;
+	if (*count == 0) {
+		//Zero is always positive with exponent 0
+		if (*tag != 0) {
+			return 0;
 		}
-		else carry = false;
+		value = BigDecimal{};
+		return static_cast<size_t>(iter - first);
 	}
-	if (carry != 0) {
-		digits.push_back('1');
+	//Checked before allocating anything, so a corrupt count can't ask for more memory than the input could fill
+	if (*count > static_cast<uint64_t>(last - iter) * 8 / groupBits * groupDigits || coefficientBytes(*count) > static_cast<size_t>(last - iter)) {
+		return 0;
 	}
-	normalize();
+	BigDecimal result{};
+	result.digits.resize(*count);
+	uint32_t buffer = 0;
+	size_t bits = 0;
+	for (size_t i = 0; i < result.digits.size(); i += groupDigits) {
+		for (; bits < groupBits; bits += 8) {
+			buffer |= std::to_integer<uint32_t>(*iter++) << bits;
+		}
+		uint32_t group = buffer & ((1u << groupBits) - 1);
+		buffer >>= groupBits;
+		bits -= groupBits;
+		for (size_t j = i; j < i + groupDigits; j++, group /= 10) {
+			if (j < result.digits.size()) {
+				result.digits[j] = static_cast<char>('0' + group % 10);
+			}
+			else if (group % 10 != 0) {
+				return 0;
+			}
+		}
+		if (group != 0) {
+			return 0;
+		}
+	}
+	//Normalized digits have no zero at either end, and the bits after the last group are zero
+	if (buffer != 0 || result.digits.front() == '0' || result.digits.back() == '0') {
+		return 0;
+	}
+	result.sign = (*tag & 1) == 0;
+	result.exponent = static_cast<int>(exponent);
+	value = std::move(result);
+	return static_cast<size_t>(iter - first);
 }
 
-void BigDecimal::doSubtract(const BigDecimal& bd) {
-	std::strong_ordering cmp = *this <=> bd;
-	if (cmp == std::strong_ordering::equal) {
-		digits.clear();
+namespace {
+	//Below this many digits, the symmetric schoolbook square beats Karatsuba
+	constexpr size_t karatsubaSquareThreshold = 48;
+	//Below this many digits in the shorter operand, schoolbook multiplication beats Karatsuba
+	constexpr size_t karatsubaThreshold = 32;
+
+	//Newton iterations start from a long double estimate, which is trusted to fewer digits than it usually has,
+	//so that precision doubling each step stays ahead of the target instead of falling a digit or two short
+	constexpr int seedDigits = 12;
+
+	//Digit characters to plain values, so the kernels below can work on uncarried columns
+	std::vector<int64_t> digitValues(const std::vector<char>& digits) {
+		std::vector<int64_t> values(digits.size());
+		std::transform(digits.begin(), digits.end(), values.begin(), [](char c) {return c - '0'; });
+		return values;
+	}
+
+	//Squares the polynomial a[0, n) and adds the result into out[0, 2n)
+	//Coefficients are left uncarried, so the same code works on the Karatsuba sums
+	void polySquare(const int64_t* a, size_t n, int64_t* out) {
+		if (n < karatsubaSquareThreshold) {
+			//Symmetric schoolbook: every cross product a[i]*a[j] appears twice, so compute it once and double it
+			for (size_t i = 0; i < n; i++) {
+				out[2 * i] += a[i] * a[i];
+				int64_t twice = 2 * a[i];
+				for (size_t j = i + 1; j < n; j++) {
+					out[i + j] += twice * a[j];
+				}
+			}
+			return;
+		}
+		//(h*B + l)^2 = h^2*B^2 + ((h + l)^2 - h^2 - l^2)*B + l^2
+		size_t low = n / 2;
+		size_t high = n - low;
+		std::vector<int64_t> sum(a + low, a + n);
+		for (size_t i = 0; i < low; i++) {
+			sum[i] += a[i];
+		}
+		std::vector<int64_t> lowSq(2 * low);
+		std::vector<int64_t> highSq(2 * high);
+		std::vector<int64_t> midSq(2 * high);
+		polySquare(a, low, lowSq.data());
+		polySquare(a + low, high, highSq.data());
+		polySquare(sum.data(), high, midSq.data());
+		for (size_t i = 0; i < lowSq.size(); i++) {
+			out[i] += lowSq[i];
+			midSq[i] -= lowSq[i];
+		}
+		for (size_t i = 0; i < highSq.size(); i++) {
+			out[2 * low + i] += highSq[i];
+			out[low + i] += midSq[i] - highSq[i];
+		}
 	}
-	else if ((cmp == std::strong_ordering::greater && sign) || (cmp == std::strong_ordering::less && !sign)) {
-		if (exponent > bd.exponent) {
-			digits.insert(digits.begin(), exponent - bd.exponent, '0');
-			exponent = bd.exponent;
+
+	//Multiplies the polynomials a[0, n) and b[0, m) and adds the result into out[0, n + m)
+	void polyMultiply(const int64_t* a, size_t n, const int64_t* b, size_t m, int64_t* out) {
+		if (n < m) {
+			std::swap(a, b);
+			std::swap(n, m);
+		}
+		if (m == 0) {
+			return;
+		}
+		if (m < karatsubaThreshold) {
+			for (size_t i = 0; i < n; i++) {
+				for (size_t j = 0; j < m; j++) {
+					out[i + j] += a[i] * b[j];
+				}
+			}
+			return;
 		}
-		int align = bd.exponent - exponent;
-		int numDigits = static_cast<int>(std::min(digits.size() - align, bd.digits.size()));
-		for (int i = 0; i < numDigits; i++) {
-			digits.at(i + align) -= bd.digits.at(i) - '0';
-			if (digits.at(i + align) < '0') {
-				digits.at(i + 1 + align)--; //this is allowed, since already know that this > bd
-				digits.at(i + align) += 10;
+		size_t low = n / 2;
+		if (m <= low) {
+			//Too unbalanced to split both; cut the longer operand into pieces the size of the shorter one instead
+			for (size_t i = 0; i < n; i += m) {
+				polyMultiply(a + i, std::min(m, n - i), b, m, out + i);
 			}
+			return;
+		}
+		//(a1*B + a0)(b1*B + b0) = a1*b1*B^2 + ((a1 + a0)(b1 + b0) - a1*b1 - a0*b0)*B + a0*b0
+		std::vector<int64_t> sumA(a + low, a + n);
+		std::vector<int64_t> sumB(b + low, b + m);
+		sumB.resize(std::max(low, m - low));
+		for (size_t i = 0; i < low; i++) {
+			sumA[i] += a[i];
+			sumB[i] += b[i];
+		}
+		std::vector<int64_t> lowProduct(2 * low);
+		std::vector<int64_t> highProduct(n + m - 2 * low);
+		std::vector<int64_t> midProduct(sumA.size() + sumB.size());
+		polyMultiply(a, low, b, low, lowProduct.data());
+		polyMultiply(a + low, n - low, b + low, m - low, highProduct.data());
+		polyMultiply(sumA.data(), sumA.size(), sumB.data(), sumB.size(), midProduct.data());
+		for (size_t i = 0; i < lowProduct.size(); i++) {
+			out[i] += lowProduct[i];
+			midProduct[i] -= lowProduct[i];
 		}
-		for (int i = numDigits + align; i < digits.size() - 1 && digits.at(i) < '0'; i++) {
-			digits.at(i) += 10;
-			digits.at(i + 1)--;
+		for (size_t i = 0; i < highProduct.size(); i++) {
+			out[2 * low + i] += highProduct[i];
+			midProduct[i] -= highProduct[i];
 		}
-		if (digits.at(digits.size() - 1) < '0') { //Something went terribly wrong
-			throw std::logic_error("Invalid digit state");
+		//The top of midProduct is zero once both halves are subtracted, and may run past out
+		for (size_t i = 0; i < midProduct.size() && low + i < n + m; i++) {
+			out[low + i] += midProduct[i];
 		}
 	}
-	else {
-		*this = bd - *this; //Creates a copy, but copies are still pretty cheap
-		sign = !sign;
+
+	//Short product: adds every a[i]*b[j] with i + j >= cut into out[i + j], skipping the rest
+	//Blocks entirely above the cut go through the full Karatsuba product, blocks entirely below are skipped,
+	//and the ones straddling it are split again, so the low triangle is never computed
+	void polyShortMultiply(const int64_t* a, size_t n, const int64_t* b, size_t m, ptrdiff_t cut, int64_t* out) {
+		if (n == 0 || m == 0 || cut > static_cast<ptrdiff_t>(n + m - 2)) {
+			return;
+		}
+		if (cut <= 0) {
+			polyMultiply(a, n, b, m, out);
+			return;
+		}
+		if (std::min(n, m) < karatsubaThreshold) {
+			for (size_t i = 0; i < n; i++) {
+				size_t first = static_cast<size_t>(std::max<ptrdiff_t>(0, cut - static_cast<ptrdiff_t>(i)));
+				for (size_t j = first; j < m; j++) {
+					out[i + j] += a[i] * b[j];
+				}
+			}
+			return;
+		}
+		size_t lowA = n / 2;
+		size_t lowB = m / 2;
+		auto lowAOffset = static_cast<ptrdiff_t>(lowA);
+		auto lowBOffset = static_cast<ptrdiff_t>(lowB);
+		polyShortMultiply(a + lowA, n - lowA, b + lowB, m - lowB, cut - lowAOffset - lowBOffset, out + lowA + lowB);
+		polyShortMultiply(a + lowA, n - lowA, b, lowB, cut - lowAOffset, out + lowA);
+		polyShortMultiply(a, lowA, b + lowB, m - lowB, cut - lowBOffset, out + lowB);
+		polyShortMultiply(a, lowA, b, lowB, cut, out);
 	}
-	normalize();
+
+	//Converts non-negative base 10 column sums into normalized digit characters, starting at column first
+	std::vector<char> carryColumns(const std::vector<int64_t>& columns, size_t first = 0) {
+		std::vector<char> result{};
+		result.reserve(columns.size() - first + 20);
+		int64_t carry = 0;
+		for (size_t i = first; i < columns.size(); i++) {
+			carry += columns[i];
+			result.push_back(static_cast<char>('0' + carry % 10));
+			carry /= 10;
+		}
+		for (; carry > 0; carry /= 10) {
+			result.push_back(static_cast<char>('0' + carry % 10));
+		}
+		return result;
+	}
+
+	//Like carryColumns, but the columns may be negative; returns true if their total is negative,
+	//in which case result holds the digits of its magnitude
+	bool carrySignedColumns(std::vector<int64_t>& columns, std::vector<char>& result) {
+		for (bool negated = false;; negated = true) {
+			result.clear();
+			result.reserve(columns.size() + 20);
+			int64_t carry = 0;
+			for (int64_t column : columns) {
+				carry += column;
+				int64_t digit = carry % 10;
+				carry /= 10;
+				if (digit < 0) {
+					digit += 10;
+					carry--;
+				}
+				result.push_back(static_cast<char>('0' + digit));
+			}
+			for (; carry > 0; carry /= 10) {
+				result.push_back(static_cast<char>('0' + carry % 10));
+			}
+			if (carry == 0) {
+				return negated;
+			}
+			//A borrow out of the top column means the total is negative, so carry its negation instead
+			for (int64_t& column : columns) {
+				column = -column;
+			}
+		}
+	}
+
+	int countDigits(size_t value) {
+		int count = 1;
+		for (; value >= 10; value /= 10) {
+			count++;
+		}
+		return count;
+	}
+
+	//digits * factor in place, for a single digit factor: one pass with a carry, and no product to allocate
+	void multiplyByDigit(std::vector<char>& digits, int factor) {
+		int carry = 0;
+		for (char& digit : digits) {
+			carry += (digit - '0') * factor;
+			digit = static_cast<char>('0' + carry % 10);
+			carry /= 10;
+		}
+		if (carry != 0) {
+			digits.push_back(static_cast<char>('0' + carry));
+		}
+	}
+}
+
+BigDecimal BigDecimal::square() const {
+	if (kind != Kind::finite) {
+		return specialResult(*this, *this, '*');
+	}
+	BigDecimal result{};
+	if (digits.empty()) {
+		return result;
+	}
+	std::vector<int64_t> values = digitValues(digits);
+	std::vector<int64_t> columns(2 * values.size());
+	polySquare(values.data(), values.size(), columns.data());
+	result.digits = carryColumns(columns);
+	result.exponent = 2 * exponent;
+	result.normalize();
+	return result;
+}
+
+BigDecimal& BigDecimal::multiplyAssign(const BigDecimal& bd) {
+	if (&bd == this) {
+		return *this = square();
+	}
+	if (kind != Kind::finite || bd.kind != Kind::finite) {
+		return *this = specialResult(*this, bd, '*');
+	}
+	if (digits.empty() || bd.digits.empty()) {
+		digits.clear();
+		normalize();
+		return *this;
+	}
+	std::vector<int64_t> lhs = digitValues(digits);
+	std::vector<int64_t> rhs = digitValues(bd.digits);
+	std::vector<int64_t> columns(lhs.size() + rhs.size());
+	polyMultiply(lhs.data(), lhs.size(), rhs.data(), rhs.size(), columns.data());
+	digits = carryColumns(columns);
+	sign = sign == bd.sign;
+	exponent += bd.exponent;
+	normalize();
+	return *this;
+}
+
+BigDecimal& BigDecimal::round(int precision) {
+	if (precision < 1) {
+		fail<std::invalid_argument>("precision must be at least 1");
+	}
+	if (digits.size() > static_cast<size_t>(precision)) {
+		*this = rounded(precision);
+	}
+	return *this;
+}
+
+BigDecimal BigDecimal::rounded(int precision) const {
+	if (precision < 1) {
+		fail<std::invalid_argument>("precision must be at least 1");
+	}
+	if (digits.size() <= static_cast<size_t>(precision)) {
+		return *this;
+	}
+	size_t drop = digits.size() - precision;
+	char first = digits[drop - 1];
+	//Scanned from the top down, so this usually stops within a digit or two instead of reading everything dropped
+	bool sticky = std::any_of(digits.rend() - static_cast<ptrdiff_t>(drop) + 1, digits.rend(), [](char c) {return c != '0'; });
+	//Round half to even
+	bool roundUp = first > '5' || (first == '5' && (sticky || (digits[drop] - '0') % 2 == 1));
+	BigDecimal result{};
+	result.digits.assign(digits.begin() + static_cast<ptrdiff_t>(drop), digits.end());
+	result.sign = sign;
+	result.exponent = exponent + static_cast<int>(drop);
+	if (roundUp) {
+		auto iter = result.digits.begin();
+		for (; iter != result.digits.end() && *iter == '9'; iter++) {
+			*iter = '0';
+		}
+		if (iter == result.digits.end()) {
+			result.digits.push_back('1');
+		}
+		else {
+			(*iter)++;
+		}
+	}
+	result.normalize();
+	return result;
+}
+
+BigDecimal multiply(const BigDecimal& lhs, const BigDecimal& rhs, int precision) {
+	if (precision < 1) {
+		fail<std::invalid_argument>("precision must be at least 1");
+	}
+	if (!lhs.isFinite() || !rhs.isFinite()) {
+		return BigDecimal::specialResult(lhs, rhs, '*');
+	}
+	size_t n = lhs.digits.size();
+	size_t m = rhs.digits.size();
+	//Every skipped column holds at most 9 * 9 * min(n, m), so all of them together are worth
+	//less than 9 * min(n, m) units of the cut column
+	int errorDigits = countDigits(9 * std::min(n, m));
+	ptrdiff_t cut = static_cast<ptrdiff_t>(n + m) - 1 - precision - errorDigits - 3;
+	if (n == 0 || m == 0 || cut <= 0) {
+		return (lhs * rhs).round(precision);
+	}
+	std::vector<int64_t> a = digitValues(lhs.digits);
+	std::vector<int64_t> b = digitValues(rhs.digits);
+	std::vector<int64_t> columns(n + m);
+	polyShortMultiply(a.data(), n, b.data(), m, cut, columns.data());
+	//The exact product lies in [low, low + 10^(cut + errorDigits)); if both ends round the same way, so does it
+	BigDecimal low{};
+	low.digits = carryColumns(columns, static_cast<size_t>(cut));
+	low.exponent = static_cast<int>(cut) + lhs.exponent + rhs.exponent;
+	low.normalize();
+	BigDecimal ulp{1};
+	ulp.exponent = static_cast<int>(cut) + errorDigits + lhs.exponent + rhs.exponent;
+	BigDecimal high = low + ulp;
+	low.round(precision);
+	if (low != high.round(precision)) {
+		//Too close to a rounding boundary to decide from the short product
+		return (lhs * rhs).round(precision);
+	}
+	low.sign = lhs.sign == rhs.sign;
+	return low;
+}
+
+void BigDecimal::multiplyAdd(const BigDecimal& factor, const std::vector<int64_t>& factorValues, const BigDecimal& addend, const std::vector<int64_t>& addendValues) {
+	if (digits.empty() || factor.digits.empty()) {
+		*this = addend;
+		return;
+	}
+	bool productSign = sign == factor.sign;
+	int productExponent = exponent + factor.exponent;
+	int base = addend.digits.empty() ? productExponent : std::min(productExponent, addend.exponent);
+	auto productOffset = static_cast<size_t>(productExponent - base);
+	size_t size = productOffset + digits.size() + factor.digits.size();
+	auto addendOffset = static_cast<size_t>(addend.exponent - base);
+	if (!addend.digits.empty()) {
+		size = std::max(size, addendOffset + addend.digits.size());
+	}
+	//The product and the addend share one set of columns, so there's a single carry pass and no intermediate product
+	std::vector<int64_t> columns(size);
+	std::vector<int64_t> values = digitValues(digits);
+	polyMultiply(values.data(), values.size(), factorValues.data(), factorValues.size(), columns.data() + productOffset);
+	int64_t addendSign = addend.sign == productSign ? 1 : -1;
+	for (size_t i = 0; i < addendValues.size(); i++) {
+		columns[addendOffset + i] += addendSign * addendValues[i];
+	}
+	bool negative = carrySignedColumns(columns, digits);
+	sign = productSign != negative;
+	exponent = base;
+	normalize();
+}
+
+BigDecimal evaluatePolynomial(std::span<const BigDecimal> coefficients, const BigDecimal& x, int precision) {
+	return evaluatePolynomial(coefficients, std::span<const BigDecimal>{&x, 1}, precision).front();
+}
+
+std::vector<BigDecimal> evaluatePolynomial(std::span<const BigDecimal> coefficients, std::span<const BigDecimal> xs, int precision) {
+	if (precision < 0) {
+		fail<std::invalid_argument>("precision can't be negative");
+	}
+	std::for_each(coefficients.begin(), coefficients.end(), requireFinite);
+	std::for_each(xs.begin(), xs.end(), requireFinite);
+	//The coefficients are converted to digit values once and shared by every point
+	std::vector<std::vector<int64_t>> coefficientValues{};
+	coefficientValues.reserve(coefficients.size());
+	for (const BigDecimal& coefficient : coefficients) {
+		coefficientValues.push_back(digitValues(coefficient.digits));
+	}
+	//Guard digits carried through each rounded step, so the final rounding absorbs their errors unless the terms cancel
+	int working = precision == 0 ? 0 : precision + 10;
+	std::vector<BigDecimal> results{};
+	results.reserve(xs.size());
+	for (const BigDecimal& x : xs) {
+		std::vector<int64_t> xValues = digitValues(x.digits);
+		BigDecimal accumulator{};
+		for (size_t i = coefficients.size(); i-- > 0;) {
+			accumulator.multiplyAdd(x, xValues, coefficients[i], coefficientValues[i]);
+			if (working != 0) {
+				accumulator.round(working);
+			}
+		}
+		if (precision != 0) {
+			accumulator.round(precision);
+		}
+		results.push_back(std::move(accumulator));
+	}
+	return results;
+}
+
+void BigDecimal::truncate(int position) {
+	int drop = position - exponent;
+	if (drop <= 0) {
+		return;
+	}
+	if (drop >= static_cast<int>(digits.size())) {
+		digits.clear();
+	}
+	else {
+		digits.erase(digits.begin(), digits.begin() + drop);
+		exponent = position;
+	}
+	normalize();
+}
+
+BigDecimal BigDecimal::powerOfTen(int power) {
+	BigDecimal result{1};
+	result.exponent = power;
+	return result;
+}
+
+namespace {
+	//Largest mantissa length that still leaves room for remainder * 10 + digit in a uint64_t
+	constexpr size_t smallDivisorDigits = 18;
+}
+
+BigDecimal BigDecimal::approximateReciprocal(const BigDecimal& bd, int precision) {
+	//Newton iteration y += y * (1 - x * y), with x scaled into [0.1, 1), doubling the precision each step
+	BigDecimal scaled = bd;
+	int shift = static_cast<int>(scaled.digits.size()) + scaled.exponent;
+	scaled.exponent -= shift;
+	scaled.sign = true;
+	BigDecimal leading = scaled;
+	leading.round(18);
+	BigDecimal y{1 / leading.toLongDouble(), 16};
+	int target = precision + 2;
+	for (int working = seedDigits; working < target;) {
+		working = std::min(2 * working, target);
+		BigDecimal error = 1 - multiply(scaled, y, 2 * working);
+		y += multiply(y, error, working);
+		y.round(working);
+	}
+	y.exponent -= shift;
+	y.sign = bd.sign;
+	return y;
+}
+
+BigDecimal::Divisor::Divisor(const BigDecimal& bd) : divisor(bd), mantissa(bd), exponent(bd.exponent) {
+	requireFinite(bd);
+	if (bd.digits.empty()) {
+		fail<std::invalid_argument>("Divisor can't be zero");
+	}
+	mantissa.sign = true;
+	mantissa.exponent = 0;
+	size_t n = mantissa.digits.size();
+	if (n <= smallDivisorDigits) {
+		for (auto iter = mantissa.digits.rbegin(); iter != mantissa.digits.rend(); iter++) {
+			smallMantissa = smallMantissa * 10 + (*iter - '0');
+		}
+		return;
+	}
+	//The estimate is within a few units of the floor, so fix it up exactly
+	reciprocal = approximateReciprocal(mantissa, static_cast<int>(n) + 2);
+	reciprocal.exponent += 2 * static_cast<int>(n);
+	reciprocal.truncate(0);
+	BigDecimal limit = powerOfTen(2 * static_cast<int>(n));
+	while (reciprocal * mantissa > limit) {
+		--reciprocal;
+	}
+	while ((reciprocal + 1) * mantissa <= limit) {
+		++reciprocal;
+	}
+}
+
+BigDecimal BigDecimal::Divisor::divMod(BigDecimal& numerator) const {
+	BigDecimal quotient{};
+	if (numerator.digits.empty()) {
+		return quotient;
+	}
+	int length = static_cast<int>(numerator.digits.size()) + numerator.exponent;
+	auto digitAt = [&numerator](int position) {
+		int index = position - numerator.exponent;
+		return index >= 0 && index < static_cast<int>(numerator.digits.size()) ? numerator.digits[index] - '0' : 0;
+	};
+	if (smallMantissa != 0) {
+		//Plain short division, one digit at a time
+		quotient.digits.resize(length);
+		uint64_t remainder = 0;
+		for (int position = length - 1; position >= 0; position--) {
+			remainder = remainder * 10 + digitAt(position);
+			quotient.digits[position] = static_cast<char>('0' + remainder / smallMantissa);
+			remainder %= smallMantissa;
+		}
+		quotient.normalize();
+		numerator = static_cast<long long>(remainder);
+		return quotient;
+	}
+	//Schoolbook division in base 10^n: each step divides a value below mantissa * 10^n by mantissa with a Barrett reduction
+	int n = static_cast<int>(mantissa.digits.size());
+	BigDecimal remainder{};
+	for (int chunkStart = (length - 1) / n * n; chunkStart >= 0; chunkStart -= n) {
+		BigDecimal chunk{};
+		for (int position = chunkStart; position < chunkStart + n; position++) {
+			chunk.digits.push_back(static_cast<char>('0' + digitAt(position)));
+		}
+		chunk.normalize();
+		remainder.exponent += n;
+		remainder += chunk;
+		BigDecimal estimate = remainder;
+		estimate.truncate(n - 1);
+		estimate.exponent -= n - 1;
+		estimate *= reciprocal;
+		estimate.truncate(n + 1);
+		estimate.exponent -= n + 1;
+		remainder -= estimate * mantissa;
+		//Barrett's estimate is at most 2 too small
+		while (remainder >= mantissa) {
+			remainder -= mantissa;
+			++estimate;
+		}
+		estimate.exponent += chunkStart;
+		quotient += estimate;
+	}
+	numerator = remainder;
+	return quotient;
+}
+
+BigDecimal operator/(const BigDecimal& lhs, const BigDecimal::Divisor& rhs) {
+	requireFinite(lhs);
+	if (lhs.digits.empty()) {
+		return {};
+	}
+	//Match operator/=, which keeps max(dividend digits, divisor digits) + 20 significant digits, truncating.
+	//Enough extra digits are computed to cover that, plus the longest possible run of zeroes after it
+	int dividendDigits = static_cast<int>(lhs.digits.size());
+	int divisorDigits = static_cast<int>(rhs.mantissa.digits.size());
+	int maxDigits = std::max(dividendDigits, divisorDigits) + 20;
+	int extra = std::max(0, maxDigits - dividendDigits + divisorDigits) + divisorDigits + 1;
+	BigDecimal numerator = lhs;
+	numerator.sign = true;
+	numerator.exponent = extra;
+	BigDecimal quotient = rhs.divMod(numerator);
+	quotient.exponent -= extra;
+	if (numerator != 0) {
+		//Long division stops at the first non-zero digit at or past the last significant position, or at the decimal point if that comes later
+		int top = static_cast<int>(quotient.digits.size()) + quotient.exponent - 1;
+		int last = top - maxDigits + 1;
+		int index = std::min(last - quotient.exponent, static_cast<int>(quotient.digits.size()) - 1);
+		for (; index > 0 && quotient.digits[index] == '0'; index--);
+		quotient.truncate(std::min(0, quotient.exponent + index));
+	}
+	quotient.exponent += lhs.exponent - rhs.exponent;
+	quotient.sign = lhs.sign == rhs.divisor.sign;
+	quotient.normalize();
+	return quotient;
+}
+
+BigDecimal operator%(const BigDecimal& lhs, const BigDecimal::Divisor& rhs) {
+	requireFinite(lhs);
+	if (lhs.digits.empty()) {
+		return {};
+	}
+	//Scale both sides to integers; divisor becomes mantissa * 10^shift
+	int scale = std::min(lhs.exponent, rhs.exponent);
+	int shift = rhs.exponent - scale;
+	BigDecimal numerator = lhs;
+	numerator.sign = true;
+	numerator.exponent -= scale;
+	//x mod (m * 10^shift) == (floor(x / 10^shift) mod m) * 10^shift + x mod 10^shift
+	BigDecimal high = numerator;
+	high.truncate(shift);
+	BigDecimal low = numerator - high;
+	high.exponent -= shift;
+	rhs.divMod(high);
+	high.exponent += shift;
+	BigDecimal result = high + low;
+	result.exponent += scale;
+	result.sign = lhs.sign;
+	result.normalize();
+	return result;
+}
+
+BigDecimal divide(const BigDecimal& lhs, const BigDecimal& rhs, int precision) {
+	return BigDecimal::divideReporting(lhs, rhs, precision, nullptr);
+}
+
+BigDecimal BigDecimal::divideReporting(const BigDecimal& lhs, const BigDecimal& rhs, int precision, bool* exact) {
+	if (precision < 1) {
+		fail<std::invalid_argument>("precision must be at least 1");
+	}
+	if (!lhs.isFinite() || !rhs.isFinite()) {
+		return specialResult(lhs, rhs, '/');
+	}
+	if (rhs.digits.empty()) {
+		fail<std::domain_error>("Division by zero");
+	}
+	if (exact != nullptr) {
+		*exact = true;
+	}
+	if (lhs.digits.empty()) {
+		return {};
+	}
+	BigDecimal numerator = lhs;
+	numerator.sign = true;
+	BigDecimal denominator = rhs;
+	denominator.sign = true;
+	BigDecimal estimate = multiply(numerator, approximateReciprocal(denominator, precision + 3), precision + 3);
+	//Take floor(quotient * 10^scale) with a couple of digits to spare, fixed up exactly against the remainder
+	int scale = precision + 2 - (static_cast<int>(estimate.digits.size()) + estimate.exponent);
+	BigDecimal quotient = estimate;
+	quotient.exponent += scale;
+	quotient.truncate(0);
+	numerator.exponent += scale;
+	BigDecimal product = quotient * denominator;
+	while (product > numerator) {
+		--quotient;
+		product -= denominator;
+	}
+	while (product + denominator <= numerator) {
+		++quotient;
+		product += denominator;
+	}
+	bool remainderZero = product == numerator;
+	if (!remainderZero) {
+		//A non-zero remainder becomes a sticky digit below the kept ones, so rounding sees it as past any halfway point
+		quotient.exponent++;
+		quotient += 1;
+		scale++;
+	}
+	quotient.exponent -= scale;
+	if (exact != nullptr) {
+		*exact = remainderZero && quotient.digits.size() <= static_cast<size_t>(precision);
+	}
+	quotient.round(precision);
+	quotient.sign = lhs.sign == rhs.sign;
+	return quotient;
+}
+
+std::optional<BigDecimal> tryDivide(const BigDecimal& lhs, const BigDecimal& rhs, int precision) {
+	if (precision < 1) {
+		return std::nullopt;
+	}
+	if (!lhs.isFinite() || !rhs.isFinite()) {
+		return BigDecimal::specialResult(lhs, rhs, '/');
+	}
+	if (rhs.digits.empty()) {
+		return std::nullopt;
+	}
+	if (lhs.digits.empty()) {
+		return BigDecimal{};
+	}
+	//The quotient's leading digit is within one place of the difference of the leading digits, and its last digit
+	//is precision - 1 places below that
+	int64_t lead = int64_t{lhs.exponent} + static_cast<int64_t>(lhs.digits.size()) - int64_t{rhs.exponent} - static_cast<int64_t>(rhs.digits.size());
+	if (lead + 1 > std::numeric_limits<int>::max() || lead - precision - 1 < std::numeric_limits<int>::min()) {
+		return std::nullopt;
+	}
+	return divide(lhs, rhs, precision);
+}
+
+BigDecimal pow(const BigDecimal& base, int64_t exponent, int precision) {
+	requireFinite(base);
+	if (precision < 0) {
+		fail<std::invalid_argument>("precision can't be negative");
+	}
+	if (exponent == 0) {
+		return 1;
+	}
+	if (base.digits.empty()) {
+		if (exponent < 0) {
+			fail<std::domain_error>("Division by zero");
+		}
+		return {};
+	}
+	bool negative = !base.sign && exponent % 2 != 0;
+	uint64_t magnitude = exponent < 0 ? 0 - static_cast<uint64_t>(exponent) : static_cast<uint64_t>(exponent);
+	BigDecimal unsignedBase = base;
+	unsignedBase.sign = true;
+	//A single significant digit d: (d * 10^e)^k == d^k * 10^(e * k), so the exponent is scaled once up front
+	int64_t shift = 0;
+	int digitFactor = 0;
+	if (base.digits.size() == 1) {
+		//Any exponent past 2^31 takes the result out of range, and bounding it first keeps the product below from
+		//overflowing int64_t
+		if (base.exponent != 0 && magnitude > uint64_t{1} << 31) {
+			fail<std::overflow_error>("BigDecimal exponent out of range");
+		}
+		shift = static_cast<int64_t>(base.exponent) * exponent;
+		if (shift > std::numeric_limits<int>::max() || shift < std::numeric_limits<int>::min()) {
+			fail<std::overflow_error>("BigDecimal exponent out of range");
+		}
+		//A power of ten only needs its exponent scaled
+		if (base.digits[0] == '1') {
+			BigDecimal result = BigDecimal::powerOfTen(static_cast<int>(shift));
+			result.sign = !negative;
+			return result;
+		}
+		digitFactor = base.digits[0] - '0';
+		unsignedBase.exponent = 0;
+	}
+	//Left to right square and multiply; for a single digit base each multiply step is an in-place pass by that digit.
+	//With a precision, intermediates carry enough guard digits to absorb the rounding error of every step
+	int working = precision == 0 ? 0 : precision + countDigits(magnitude) + 3;
+	BigDecimal result = unsignedBase;
+	int bit = std::numeric_limits<uint64_t>::digits - 1;
+	for (; (magnitude >> bit & 1) == 0; bit--);
+	for (bit--; bit >= 0; bit--) {
+		result = working == 0 ? result.square() : multiply(result, result, working);
+		if ((magnitude >> bit & 1) == 0) {
+			continue;
+		}
+		if (digitFactor != 0) {
+			multiplyByDigit(result.digits, digitFactor);
+			if (working != 0) {
+				result.round(working);
+			}
+		}
+		else {
+			result = working == 0 ? result * unsignedBase : multiply(result, unsignedBase, working);
+		}
+	}
+	if (exponent < 0) {
+		result = precision == 0 ? 1 / result : divide(1, result, precision);
+	}
+	else if (precision != 0) {
+		result.round(precision);
+	}
+	if (shift != 0 && !result.digits.empty()) {
+		int64_t scaled = result.exponent + shift;
+		if (scaled > std::numeric_limits<int>::max() || scaled < std::numeric_limits<int>::min()) {
+			fail<std::overflow_error>("BigDecimal exponent out of range");
+		}
+		result.exponent = static_cast<int>(scaled);
+	}
+	result.sign = !negative;
+	if (result.digits.empty()) {
+		result.sign = true;
+	}
+	return result;
+}
+
+BigDecimal BigDecimal::roundRoot(const BigDecimal& radicand, int n, const BigDecimal& estimate, int precision) {
+	//Take floor(root * 10^scale) with a couple of digits to spare, fixed up exactly so that
+	//root^n <= radicand * 10^(n * scale) < (root + 1)^n
+	int scale = precision + 2 - (static_cast<int>(estimate.digits.size()) + estimate.exponent);
+	BigDecimal result = estimate;
+	result.sign = true;
+	result.exponent += scale;
+	result.truncate(0);
+	BigDecimal target = radicand;
+	target.sign = true;
+	target.exponent += n * scale;
+	BigDecimal power = pow(result, n);
+	while (power > target) {
+		--result;
+		power = pow(result, n);
+	}
+	for (BigDecimal next = pow(result + 1, n); next <= target; next = pow(result + 1, n)) {
+		++result;
+		power = std::move(next);
+	}
+	if (power != target) {
+		//Inexact, so add a sticky digit below the kept ones for rounding
+		result.exponent++;
+		result += 1;
+		scale++;
+	}
+	result.exponent -= scale;
+	result.round(precision);
+	return result;
+}
+
+BigDecimal root(const BigDecimal& bd, int n, int precision) {
+	requireFinite(bd);
+	if (n < 1 || precision < 1) {
+		fail<std::invalid_argument>("root needs a positive degree and precision");
+	}
+	if (!bd.sign && n % 2 == 0) {
+		fail<std::domain_error>("Even root of a negative number");
+	}
+	if (bd.digits.empty()) {
+		return {};
+	}
+	//bd == scaled * 10^shift with shift a multiple of n and scaled in [10^-n, 1)
+	int top = static_cast<int>(bd.digits.size()) + bd.exponent;
+	int shift = top % n == 0 ? top : top + (top > 0 ? n - top % n : -(top % n));
+	BigDecimal scaled = bd;
+	scaled.sign = true;
+	scaled.exponent -= shift;
+	BigDecimal leading = scaled;
+	leading.exponent -= top - shift;
+	leading.round(18);
+	long double logScaled = std::log10(leading.toLongDouble()) + (top - shift);
+	BigDecimal y{std::pow(10.0L, -logScaled / n), 16};
+	//Newton iteration for y ~ scaled^(-1/n), which needs no division by y: y += y * (1 - scaled * y^n) / n
+	int target = precision + 4;
+	for (int working = seedDigits; working < target;) {
+		working = std::min(2 * working, target);
+		BigDecimal error = 1 - multiply(scaled, pow(y, n, 2 * working), 2 * working);
+		y += divide(multiply(y, error, working), n, working);
+		y.round(working);
+	}
+	//scaled^(1/n) == scaled * y^(n - 1)
+	BigDecimal estimate = n == 1 ? scaled : multiply(scaled, pow(y, n - 1, target), target);
+	estimate.exponent += shift / n;
+	BigDecimal result = BigDecimal::roundRoot(bd, n, estimate, precision);
+	result.sign = bd.sign;
+	return result;
+}
+
+BigDecimal sqrt(const BigDecimal& bd, int precision) {
+	requireFinite(bd);
+	return root(bd, 2, precision);
+}
+
+namespace {
+	//One term of a series sum of a(n) / b(n) * p(0)...p(n) / (q(0)...q(n))
+	struct SeriesTerm {
+		BigDecimal a, b, p, q;
+	};
+
+	//Partial products over a range of terms; the range sums to t / (b * q)
+	struct SplitSum {
+		BigDecimal p, q, b, t;
+	};
+
+	//Binary splitting (Haible and Papanikolaou): the exact integer products are built as a balanced tree,
+	//so most of the work lands in a few large multiplies where Karatsuba pays off
+	template<class Terms>
+	SplitSum binarySplit(const Terms& terms, int64_t first, int64_t last) {
+		if (last - first == 1) {
+			SeriesTerm term = terms(first);
+			BigDecimal t = term.a * term.p;
+			return {std::move(term.p), std::move(term.q), std::move(term.b), std::move(t)};
+		}
+		int64_t middle = first + (last - first) / 2;
+		SplitSum left = binarySplit(terms, first, middle);
+		SplitSum right = binarySplit(terms, middle, last);
+		BigDecimal t = right.b * right.q * left.t + left.b * left.p * right.t;
+		return {left.p * right.p, left.q * right.q, left.b * right.b, std::move(t)};
+	}
+
+	template<class Terms>
+	BigDecimal sumSeries(const Terms& terms, int64_t count, int precision) {
+		SplitSum sum = binarySplit(terms, 0, count);
+		return divide(sum.t, sum.b * sum.q, precision);
+	}
+
+	BigDecimal tenTo(int64_t power) {
+		return pow(BigDecimal{10}, power);
+	}
+
+	BigDecimal magnitude(const BigDecimal& bd) {
+		return bd < 0 ? 0 - bd : bd;
+	}
+
+	//atanh(1 / x), the sum of 1 / ((2n + 1) x^(2n + 1))
+	BigDecimal atanhReciprocal(int64_t x, int precision) {
+		auto count = static_cast<int64_t>((precision + 3) / (2 * std::log10(static_cast<long double>(x)))) + 2;
+		auto terms = [x](int64_t n) {
+			return SeriesTerm{1, 2 * n + 1, 1, n == 0 ? BigDecimal{x} : BigDecimal{x * x}};
+		};
+		return sumSeries(terms, count, precision + 3);
+	}
+
+	BigDecimal lnTwo(int precision) {
+		//ln(2) == 2 atanh(1/3)
+		return multiply(2, atanhReciprocal(3, precision + 2), precision + 2);
+	}
+
+	BigDecimal lnTen(int precision) {
+		//ln(10) == 3 ln(2) + ln(5/4), and ln(5/4) == 2 atanh(1/9)
+		return multiply(3, lnTwo(precision + 3), precision + 3) + multiply(2, atanhReciprocal(9, precision + 3), precision + 3);
+	}
+
+	BigDecimal piChudnovsky(int precision) {
+		//pi == 426880 sqrt(10005) / sum of (6k)! (13591409 + 545140134k) / ((3k)! (k!)^3 (-640320)^(3k))
+		//Each term adds a little over 14 digits
+		int64_t count = (precision + 3) / 14 + 2;
+		auto terms = [](int64_t k) {
+			if (k == 0) {
+				return SeriesTerm{13591409, 1, 1, 1};
+			}
+			BigDecimal p = BigDecimal{6 * k - 5} * BigDecimal{2 * k - 1} * BigDecimal{6 * k - 1};
+			BigDecimal q = BigDecimal{k} * BigDecimal{k} * BigDecimal{k} * BigDecimal{10939058860032000LL};
+			return SeriesTerm{13591409 + 545140134 * BigDecimal{k}, 1, 0 - p, std::move(q)};
+		};
+		BigDecimal sum = sumSeries(terms, count, precision + 3);
+		return divide(multiply(426880, sqrt(10005, precision + 3), precision + 3), sum, precision + 2);
+	}
+
+	BigDecimal eSeries(int precision) {
+		//e == sum of 1 / n!, with enough terms that n! passes 10^(precision + 3)
+		int64_t count = 1;
+		for (long double logFactorial = 0; logFactorial < precision + 3; count++) {
+			logFactorial += std::log10(static_cast<long double>(count));
+		}
+		auto terms = [](int64_t n) {
+			return SeriesTerm{1, 1, 1, n == 0 ? 1 : BigDecimal{n}};
+		};
+		return sumSeries(terms, count + 1, precision + 2);
+	}
+
+	//Holds the most precise value computed so far, and only recomputes when asked for more digits than that.
+	//Readers just load the current entry, which is never modified once published; extending takes a lock so
+	//concurrent requests for more digits compute them once
+	class ConstantCache {
+	public:
+		explicit ConstantCache(BigDecimal (*compute)(int)) : compute(compute) {}
+
+		//Good to about precision significant digits
+		BigDecimal get(int precision) {
+			std::shared_ptr<const Entry> entry = current.load(std::memory_order_acquire);
+			if (!entry || entry->precision < precision) {
+				entry = extend(precision);
+			}
+			//Only the kept digits are copied, so a short request costs the same however far the cache has grown
+			return entry->value.rounded(precision);
+		}
+	private:
+		struct Entry {
+			BigDecimal value;
+			int precision;
+		};
+
+		std::shared_ptr<const Entry> extend(int precision) {
+			std::lock_guard lock{extending};
+			std::shared_ptr<const Entry> entry = current.load(std::memory_order_acquire);
+			if (entry && entry->precision >= precision) {
+				return entry;
+			}
+			//Grow geometrically, so a run of slowly increasing requests (like Ziv retries) only recomputes a few times
+			if (entry) {
+				precision = std::max(precision, entry->precision + entry->precision / 2);
+			}
+			entry = std::make_shared<const Entry>(Entry{compute(precision + 2), precision});
+			current.store(entry, std::memory_order_release);
+			return entry;
+		}
+
+		BigDecimal (*compute)(int);
+		std::atomic<std::shared_ptr<const Entry>> current{};
+		std::mutex extending{};
+	};
+
+	ConstantCache& piCache() {
+		static ConstantCache cache{piChudnovsky};
+		return cache;
+	}
+
+	ConstantCache& eCache() {
+		static ConstantCache cache{eSeries};
+		return cache;
+	}
+
+	ConstantCache& lnTwoCache() {
+		static ConstantCache cache{lnTwo};
+		return cache;
+	}
+
+	ConstantCache& lnTenCache() {
+		static ConstantCache cache{lnTen};
+		return cache;
+	}
+
+	//Ziv's strategy: evaluate with some guard digits, and retry with more if the error bound straddles a rounding boundary.
+	//evaluate(n) must be good to a relative error of 10^-n. A result that's exactly halfway between two roundings never
+	//resolves, so after a few retries the plain rounding of the last approximation is accepted
+	template<class Evaluate>
+	BigDecimal roundCorrectly(const Evaluate& evaluate, int precision) {
+		for (int guard = 8;; guard *= 2) {
+			BigDecimal approx = evaluate(precision + guard);
+			BigDecimal error = multiply(magnitude(approx), tenTo(1 - precision - guard), 5);
+			BigDecimal low = (approx - error).round(precision);
+			if (low == (approx + error).round(precision)) {
+				return low;
+			}
+			if (guard >= 128) {
+				return approx.round(precision);
+			}
+		}
+	}
+
+	//Above this many digits, logarithms use the AGM instead of Newton's method on exp
+	constexpr int agmLogThreshold = 3000;
+}
+
+long double BigDecimal::log10Magnitude(const BigDecimal& bd) {
+	BigDecimal leading = bd;
+	leading.round(18);
+	leading.sign = true;
+	//Scale into [1, 10) so the conversion can neither overflow nor underflow
+	int scale = static_cast<int>(leading.digits.size()) + leading.exponent - 1;
+	leading.exponent -= scale;
+	return std::log10(leading.toLongDouble()) + scale;
+}
+
+BigDecimal BigDecimal::expApprox(const BigDecimal& x, int precision) {
+	int working = precision + 5;
+	//exp(x) == 10^k exp(x - k ln(10)), with k picked so the remainder is at most about 1.2 in magnitude
+	BigDecimal leading = x;
+	leading.round(18);
+	long double estimate = leading.toLongDouble() / std::log(10.0L);
+	//A result too large or too small for the exponent; the small side is an underflow, as in toInt64
+	if (estimate > std::numeric_limits<int>::max() / 2) {
+		fail<std::overflow_error>("BigDecimal exponent out of range");
+	}
+	if (estimate < -(std::numeric_limits<int>::max() / 2)) {
+		fail<std::underflow_error>("BigDecimal exponent out of range");
+	}
+	auto k = static_cast<int64_t>(std::llround(estimate));
+	BigDecimal remainder = x;
+	if (k != 0) {
+		int digits = working + countDigits(static_cast<size_t>(std::abs(k))) + 2;
+		remainder -= multiply(k, lnTenCache().get(digits), digits);
+	}
+	remainder.truncate(-working - 2);
+	//Bit-burst: split the remainder into chunks a / 10^m holding fraction digits (m / 2, m], each of whose
+	//Taylor series needs fewer terms than the last, and sum those series by binary splitting
+	BigDecimal result{1};
+	for (int high = 1; !remainder.digits.empty(); high *= 2) {
+		BigDecimal chunk = remainder;
+		chunk.truncate(-high);
+		remainder -= chunk;
+		if (chunk.digits.empty()) {
+			continue;
+		}
+		chunk.exponent += high;
+		//Terms shrink by |chunk| / 10^high / n each
+		long double ratio = log10Magnitude(chunk) - high;
+		int64_t count = 1;
+		for (long double logTerm = 0; logTerm > -working - 2 || static_cast<long double>(count) < std::pow(10.0L, ratio); count++) {
+			logTerm += ratio - std::log10(static_cast<long double>(count));
+		}
+		BigDecimal scale = powerOfTen(high);
+		auto terms = [&chunk, &scale](int64_t n) {
+			if (n == 0) {
+				return SeriesTerm{1, 1, 1, 1};
+			}
+			return SeriesTerm{1, 1, chunk, BigDecimal{n} * scale};
+		};
+		result = multiply(result, sumSeries(terms, count + 1, working), working);
+	}
+	result.exponent += static_cast<int>(k);
+	return result;
+}
+
+BigDecimal BigDecimal::logApprox(const BigDecimal& x, int precision) {
+	//log(x) == log(m) + e ln(10), with e picked so m is in [1 / sqrt(10), sqrt(10))
+	int e = static_cast<int>(x.digits.size()) + x.exponent - 1;
+	BigDecimal m = x;
+	m.exponent -= e;
+	if (m >= BigDecimal{"3.16227766016837933"}) {
+		m.exponent--;
+		e++;
+	}
+	//When m is close to 1, log(m) is tiny, so the digits cancelled in m - 1 are needed on top
+	BigDecimal offset = m - 1;
+	int cancelled = offset.digits.empty() ? 0 : std::max(0, -(static_cast<int>(offset.digits.size()) + offset.exponent));
+	int working = precision + cancelled + 5;
+	BigDecimal result{};
+	if (offset.digits.empty()) {
+		//log(1) == 0
+	}
+	else if (working > agmLogThreshold) {
+		//log(s) ~ pi / (2 AGM(1, 4 / s)) with an error around 1 / s^2, so scale m up to s = m 10^j with j past half the precision
+		int j = working / 2 + 2;
+		int agmWorking = working + countDigits(static_cast<size_t>(j)) + 2;
+		BigDecimal s = m;
+		s.exponent += j;
+		BigDecimal a{1};
+		BigDecimal b = divide(4, s, agmWorking);
+		while (true) {
+			BigDecimal difference = a - b;
+			if (difference.digits.empty() || static_cast<int>(difference.digits.size()) + difference.exponent < -agmWorking) {
+				break;
+			}
+			BigDecimal mean = multiply(a + b, BigDecimal{"0.5"}, agmWorking);
+			b = sqrt(multiply(a, b, agmWorking + 2), agmWorking);
+			a = std::move(mean);
+		}
+		result = divide(piCache().get(agmWorking), multiply(2, a, agmWorking), agmWorking);
+		result -= multiply(j, lnTenCache().get(agmWorking), agmWorking);
+	}
+	else {
+		//Newton's method on exp(y) == m: y += m exp(-y) - 1, doubling the working precision each step
+		BigDecimal leading = m;
+		leading.round(18);
+		result = BigDecimal{std::log(leading.toLongDouble()), 16};
+		int target = working + 2;
+		for (int step = seedDigits; step < target;) {
+			step = std::min(2 * step, target);
+			result += multiply(m, expApprox(0 - result, step), step) - 1;
+			result.truncate(-step - 2);
+		}
+		//One more step at full precision in case the estimate was poor
+		result += multiply(m, expApprox(0 - result, target), target) - 1;
+	}
+	if (e != 0) {
+		int digits = working + countDigits(static_cast<size_t>(std::abs(e)));
+		result += multiply(e, lnTenCache().get(digits), digits);
+	}
+	return result;
+}
+
+BigDecimal exp(const BigDecimal& x, int precision) {
+	requireFinite(x);
+	if (precision < 1) {
+		fail<std::invalid_argument>("precision must be at least 1");
+	}
+	return roundCorrectly([&x](int working) { return BigDecimal::expApprox(x, working); }, precision);
+}
+
+BigDecimal log(const BigDecimal& x, int precision) {
+	requireFinite(x);
+	if (precision < 1) {
+		fail<std::invalid_argument>("precision must be at least 1");
+	}
+	if (x <= 0) {
+		fail<std::domain_error>("Logarithm of a non-positive number");
+	}
+	return roundCorrectly([&x](int working) { return BigDecimal::logApprox(x, working); }, precision);
+}
+
+BigDecimal log10(const BigDecimal& x, int precision) {
+	requireFinite(x);
+	if (precision < 1) {
+		fail<std::invalid_argument>("precision must be at least 1");
+	}
+	if (x <= 0) {
+		fail<std::domain_error>("Logarithm of a non-positive number");
+	}
+	//Powers of ten are exact
+	if (x.digits.size() == 1 && x.digits[0] == '1') {
+		return BigDecimal{x.exponent}.round(precision);
+	}
+	return roundCorrectly([&x](int working) {
+		return divide(BigDecimal::logApprox(x, working + 2), lnTenCache().get(working + 2), working + 1);
+	}, precision);
+}
+
+BigDecimal BigDecimal::pi(int precision) {
+	if (precision < 1) {
+		fail<std::invalid_argument>("precision must be at least 1");
+	}
+	return roundCorrectly([](int working) { return piCache().get(working); }, precision);
+}
+
+BigDecimal BigDecimal::e(int precision) {
+	if (precision < 1) {
+		fail<std::invalid_argument>("precision must be at least 1");
+	}
+	return roundCorrectly([](int working) { return eCache().get(working); }, precision);
+}
+
+BigDecimal BigDecimal::ln2(int precision) {
+	if (precision < 1) {
+		fail<std::invalid_argument>("precision must be at least 1");
+	}
+	return roundCorrectly([](int working) { return lnTwoCache().get(working); }, precision);
+}
+
+BigDecimal BigDecimal::ln10(int precision) {
+	if (precision < 1) {
+		fail<std::invalid_argument>("precision must be at least 1");
+	}
+	return roundCorrectly([](int working) { return lnTenCache().get(working); }, precision);
+}
+
+BigDecimal pow(const BigDecimal& base, const BigDecimal& exponent, int precision) {
+	requireFinite(base);
+	requireFinite(exponent);
+	if (precision < 1) {
+		fail<std::invalid_argument>("precision must be at least 1");
+	}
+	if (exponent.isInteger() && static_cast<int>(exponent.digits.size()) + exponent.exponent <= 18) {
+		return pow(base, BigDecimal{exponent}.toInt64(), precision);
+	}
+	if (base.digits.empty()) {
+		if (!exponent.sign) {
+			fail<std::domain_error>("Division by zero");
+		}
+		return {};
+	}
+	if (!base.sign) {
+		fail<std::domain_error>("Non-integer power of a negative number");
+	}
+	//base^exponent == exp(exponent log(base)); exp turns absolute error in its argument into relative error,
+	//so the product needs extra digits for its integer part
+	long double logBase = std::abs(BigDecimal::log10Magnitude(base) * std::log(10.0L));
+	long double size = BigDecimal::log10Magnitude(exponent) + std::log10(logBase + 1e-18L);
+	int integerDigits = countDigits(static_cast<size_t>(std::pow(10.0L, std::min(size, 18.0L))));
+	return roundCorrectly([&](int working) {
+		int digits = working + integerDigits + 2;
+		return BigDecimal::expApprox(multiply(exponent, BigDecimal::logApprox(base, digits), digits), working);
+	}, precision);
+}
+
+std::pair<BigDecimal, BigDecimal> BigDecimal::sinCosApprox(const BigDecimal& x, int precision) {
+	int working = precision + 5;
+	//x == r + k pi / 2 with |r| at most about pi / 4, and k mod 4 picks which of sin(r) and cos(r) is which
+	BigDecimal reduced = x;
+	int quadrant = 0;
+	int top = static_cast<int>(x.digits.size()) + x.exponent;
+	if (!x.digits.empty() && top > 0) {
+		BigDecimal k = divide(x, multiply(piCache().get(top + 4), BigDecimal{"0.5"}, top + 4), top + 2);
+		k += k.sign ? BigDecimal{"0.5"} : BigDecimal{"-0.5"};
+		k.truncate(0);
+		if (!k.digits.empty()) {
+			quadrant = static_cast<int>((k % 4).toInt64());
+			quadrant = (quadrant + 4) % 4;
+			//When x is close to a multiple of pi / 2, r loses its leading digits to cancellation, so take pi to that many more
+			for (int extra = 0;;) {
+				int digits = working + top + extra + 2;
+				BigDecimal halfPi = multiply(piCache().get(digits), BigDecimal{"0.5"}, digits);
+				reduced = x - multiply(k, halfPi, digits);
+				int cancelled = reduced.digits.empty() ? 2 * extra + working : std::max(0, -(static_cast<int>(reduced.digits.size()) + reduced.exponent));
+				if (cancelled <= extra) {
+					break;
+				}
+				extra = cancelled;
+			}
+		}
+	}
+	BigDecimal sine{};
+	BigDecimal cosine{1};
+	if (!reduced.digits.empty()) {
+		reduced.truncate(static_cast<int>(reduced.digits.size()) + reduced.exponent - working - 2);
+	}
+	//Bit-burst, as in expApprox: each chunk a / 10^m gets its own pair of series, and they're combined with
+	//sin(s + t) == sin(s) cos(t) + cos(s) sin(t) and cos(s + t) == cos(s) cos(t) - sin(s) sin(t).
+	//The chunks all share r's sign, so neither combination cancels
+	for (int high = 1; !reduced.digits.empty(); high *= 2) {
+		BigDecimal chunk = reduced;
+		chunk.truncate(-high);
+		reduced -= chunk;
+		if (chunk.digits.empty()) {
+			continue;
+		}
+		chunk.exponent += high;
+		//Terms shrink by chunk^2 / 10^(2 high) / (2n (2n + 1)) each
+		long double ratio = log10Magnitude(chunk) - high;
+		int64_t count = 1;
+		for (long double logTerm = 2 * ratio - std::log10(6.0L); logTerm > -working - 2 || static_cast<long double>(2 * count) < std::pow(10.0L, ratio); count++) {
+			logTerm += 2 * ratio - std::log10(static_cast<long double>((2 * count + 2) * (2 * count + 3)));
+		}
+		BigDecimal scale = powerOfTen(high);
+		BigDecimal scaleSquared = powerOfTen(2 * high);
+		BigDecimal chunkSquared = 0 - chunk.square();
+		auto sineTerms = [&](int64_t n) {
+			if (n == 0) {
+				return SeriesTerm{1, 1, chunk, scale};
+			}
+			return SeriesTerm{1, 1, chunkSquared, BigDecimal{2 * n} * BigDecimal{2 * n + 1} * scaleSquared};
+		};
+		auto cosineTerms = [&](int64_t n) {
+			if (n == 0) {
+				return SeriesTerm{1, 1, 1, 1};
+			}
+			return SeriesTerm{1, 1, chunkSquared, BigDecimal{2 * n - 1} * BigDecimal{2 * n} * scaleSquared};
+		};
+		BigDecimal chunkSine = sumSeries(sineTerms, count + 1, working);
+		BigDecimal chunkCosine = sumSeries(cosineTerms, count + 1, working);
+		BigDecimal nextSine = multiply(sine, chunkCosine, working) + multiply(cosine, chunkSine, working);
+		cosine = multiply(cosine, chunkCosine, working) - multiply(sine, chunkSine, working);
+		sine = std::move(nextSine);
+	}
+	switch (quadrant) {
+		case 1:
+			return {cosine, 0 - sine};
+		case 2:
+			return {0 - sine, 0 - cosine};
+		case 3:
+			return {0 - cosine, sine};
+		default:
+			return {sine, cosine};
+	}
+}
+
+BigDecimal BigDecimal::atanApprox(const BigDecimal& x, int precision) {
+	if (x.digits.empty()) {
+		return {};
+	}
+	int working = precision + 5;
+	//atan(x) == +-pi / 2 - atan(1 / x), which keeps Newton's method below away from the poles of tan
+	if (compareMagnitude(x, 1) == std::strong_ordering::greater) {
+		BigDecimal halfPi = multiply(piCache().get(working), BigDecimal{"0.5"}, working);
+		BigDecimal result = atanApprox(divide(1, x, working + 2), working);
+		return x.sign ? halfPi - result : 0 - halfPi - result;
+	}
+	//Newton's method on tan(y) == x: y += (x cos(y) - sin(y)) / (cos(y) + x sin(y)), doubling the working precision each step
+	BigDecimal leading = x;
+	leading.round(18);
+	BigDecimal result{std::atan(leading.toLongDouble()), 16};
+	auto step = [&x, &result](int digits) {
+		auto [sine, cosine] = sinCosApprox(result, digits);
+		BigDecimal numerator = multiply(x, cosine, digits) - sine;
+		result += divide(numerator, cosine + multiply(x, sine, digits), digits);
+	};
+	int target = working + 2;
+	for (int digits = seedDigits; digits < target;) {
+		digits = std::min(2 * digits, target);
+		step(digits);
+		result.round(digits + 2);
+	}
+	//One more step at full precision in case the estimate was poor
+	step(target);
+	return result;
+}
+
+BigDecimal sin(const BigDecimal& x, int precision) {
+	requireFinite(x);
+	if (precision < 1) {
+		fail<std::invalid_argument>("precision must be at least 1");
+	}
+	return roundCorrectly([&x](int working) { return BigDecimal::sinCosApprox(x, working).first; }, precision);
+}
+
+BigDecimal cos(const BigDecimal& x, int precision) {
+	requireFinite(x);
+	if (precision < 1) {
+		fail<std::invalid_argument>("precision must be at least 1");
+	}
+	return roundCorrectly([&x](int working) { return BigDecimal::sinCosApprox(x, working).second; }, precision);
+}
+
+BigDecimal tan(const BigDecimal& x, int precision) {
+	requireFinite(x);
+	if (precision < 1) {
+		fail<std::invalid_argument>("precision must be at least 1");
+	}
+	return roundCorrectly([&x](int working) {
+		auto [sine, cosine] = BigDecimal::sinCosApprox(x, working + 2);
+		return divide(sine, cosine, working + 1);
+	}, precision);
+}
+
+BigDecimal atan(const BigDecimal& x, int precision) {
+	requireFinite(x);
+	if (precision < 1) {
+		fail<std::invalid_argument>("precision must be at least 1");
+	}
+	return roundCorrectly([&x](int working) { return BigDecimal::atanApprox(x, working); }, precision);
+}
+
+namespace {
+	//term(first) * ... * term(last - 1) as a balanced tree, so the big multiplies are between operands of similar size
+	template<class Term>
+	BigDecimal productTree(const Term& term, int64_t first, int64_t last) {
+		if (last - first == 1) {
+			return term(first);
+		}
+		if (last <= first) {
+			return 1;
+		}
+		int64_t middle = first + (last - first) / 2;
+		return productTree(term, first, middle) * productTree(term, middle, last);
+	}
+
+	//Multiplies runs of factors together while they fit in a machine word, which cuts the leaves of the tree by a large factor
+	BigDecimal productOf(const std::vector<uint64_t>& factors) {
+		std::vector<uint64_t> words{};
+		uint64_t word = 1;
+		for (uint64_t factor : factors) {
+			if (word > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) / factor) {
+				words.push_back(word);
+				word = 1;
+			}
+			word *= factor;
+		}
+		words.push_back(word);
+		auto term = [&words](int64_t i) { return BigDecimal{static_cast<long long>(words[i])}; };
+		return productTree(term, 0, static_cast<int64_t>(words.size()));
+	}
+
+	std::vector<uint64_t> primesUpTo(uint64_t n) {
+		std::vector<bool> composite(n + 1);
+		std::vector<uint64_t> primes{};
+		for (uint64_t i = 2; i <= n; i++) {
+			if (!composite[i]) {
+				primes.push_back(i);
+				for (uint64_t j = i * i; j <= n; j += i) {
+					composite[j] = true;
+				}
+			}
+		}
+		return primes;
+	}
+
+	//The exponent of p in n!, by Legendre's formula
+	uint64_t factorialExponent(uint64_t n, uint64_t p) {
+		uint64_t exponent = 0;
+		for (; n > 0; n /= p) {
+			exponent += n / p;
+		}
+		return exponent;
+	}
+
+	//n! / ((n / 2)!)^2, whose prime p appears to the power of the number of odd floor(n / p^i)
+	BigDecimal primeSwing(uint64_t n, const std::vector<uint64_t>& primes) {
+		std::vector<uint64_t> factors{};
+		for (uint64_t p : primes) {
+			if (p > n) {
+				break;
+			}
+			for (uint64_t q = n / p; q > 0; q /= p) {
+				if (q % 2 == 1) {
+					factors.push_back(p);
+				}
+			}
+		}
+		return productOf(factors);
+	}
+
+	BigDecimal swingFactorial(uint64_t n, const std::vector<uint64_t>& primes) {
+		if (n < 20) {
+			uint64_t result = 1;
+			for (uint64_t i = 2; i <= n; i++) {
+				result *= i;
+			}
+			return BigDecimal{static_cast<long long>(result)};
+		}
+		return swingFactorial(n / 2, primes).square() * primeSwing(n, primes);
+	}
+}
+
+BigDecimal factorial(int64_t n) {
+	if (n < 0) {
+		fail<std::invalid_argument>("factorial of a negative number");
+	}
+	//n! == ((n / 2)!)^2 swing(n); the swing only has about n / ln(n) prime factors, and most of the rest is one squaring
+	return swingFactorial(static_cast<uint64_t>(n), primesUpTo(static_cast<uint64_t>(n)));
+}
+
+BigDecimal binomial(int64_t n, int64_t k) {
+	if (n < 0) {
+		//Upper negation: C(n, k) == (-1)^k C(k - n - 1, k)
+		if (k < 0) {
+			return 0;
+		}
+		BigDecimal result = binomial(k - n - 1, k);
+		return k % 2 == 0 ? result : 0 - result;
+	}
+	if (k < 0 || k > n) {
+		return 0;
+	}
+	k = std::min(k, n - k);
+	if (k * 16 < n) {
+		//Sieving up to n would cost more than the k factors themselves; the quotient is exact, so dividing
+		//to as many digits as the numerator has gives it without rounding
+		int digits = static_cast<int>(static_cast<long double>(k) * std::log10(static_cast<long double>(n))) + 2;
+		return divide(fallingFactorial(n, k), factorial(k), digits);
+	}
+	//Each prime's exponent in n! / (k! (n - k)!) comes straight from Legendre's formula, so no division is needed
+	auto top = static_cast<uint64_t>(n);
+	std::vector<uint64_t> factors{};
+	for (uint64_t p : primesUpTo(top)) {
+		uint64_t exponent = factorialExponent(top, p) - factorialExponent(static_cast<uint64_t>(k), p) - factorialExponent(static_cast<uint64_t>(n - k), p);
+		factors.insert(factors.end(), exponent, p);
+	}
+	return productOf(factors);
+}
+
+BigDecimal risingFactorial(const BigDecimal& x, int64_t n) {
+	requireFinite(x);
+	if (n < 0) {
+		fail<std::invalid_argument>("rising factorial needs a non-negative count");
+	}
+	return productTree([&x](int64_t i) { return x + BigDecimal{i}; }, 0, n);
+}
+
+BigDecimal fallingFactorial(const BigDecimal& x, int64_t n) {
+	requireFinite(x);
+	if (n < 0) {
+		fail<std::invalid_argument>("falling factorial needs a non-negative count");
+	}
+	return productTree([&x](int64_t i) { return x - BigDecimal{i}; }, 0, n);
+}
+
+BigDecimal gcd(const BigDecimal& lhs, const BigDecimal& rhs) {
+	requireFinite(lhs);
+	requireFinite(rhs);
+	if (!lhs.isInteger() || !rhs.isInteger()) {
+		fail<std::invalid_argument>("gcd needs integer arguments");
+	}
+	BigDecimal a = lhs;
+	BigDecimal b = rhs;
+	a.sign = true;
+	b.sign = true;
+	if (a < b) {
+		std::swap(a, b);
+	}
+	//Lehmer: run Euclid on the leading digits alone for as long as they determine the quotients, collecting the steps
+	//in a 2x2 matrix of word-sized cofactors, then apply the matrix to the full values at once
+	constexpr int window = 17;
+	auto digitCount = [](const BigDecimal& bd) { return static_cast<int>(bd.digits.size()) + bd.exponent; };
+	auto leading = [](const BigDecimal& bd, int shift) {
+		BigDecimal top = bd;
+		top.truncate(shift);
+		if (top.digits.empty()) {
+			return int64_t{0};
+		}
+		top.exponent -= shift;
+		return top.toInt64();
+	};
+	while (!b.digits.empty() && digitCount(b) > window) {
+		int shift = digitCount(a) - window;
+		int64_t x = leading(a, shift);
+		int64_t y = leading(b, shift);
+		int64_t cofactorA = 1, cofactorB = 0, cofactorC = 0, cofactorD = 1;
+		while (y + cofactorC != 0 && y + cofactorD != 0) {
+			int64_t quotient = (x + cofactorA) / (y + cofactorC);
+			if (quotient != (x + cofactorB) / (y + cofactorD)) {
+				break;
+			}
+			cofactorA = std::exchange(cofactorC, cofactorA - quotient * cofactorC);
+			cofactorB = std::exchange(cofactorD, cofactorB - quotient * cofactorD);
+			x = std::exchange(y, x - quotient * y);
+		}
+		if (cofactorB == 0) {
+			//The leading digits couldn't settle even one quotient, so take a full step
+			BigDecimal remainder = a % BigDecimal::Divisor{b};
+			a = std::move(b);
+			b = std::move(remainder);
+		}
+		else {
+			BigDecimal nextA = BigDecimal{cofactorA} * a + BigDecimal{cofactorB} * b;
+			b = BigDecimal{cofactorC} * a + BigDecimal{cofactorD} * b;
+			a = std::move(nextA);
+		}
+	}
+	if (b.digits.empty()) {
+		return a;
+	}
+	if (digitCount(a) > window) {
+		a = a % BigDecimal::Divisor{b};
+	}
+	return BigDecimal{static_cast<long long>(std::gcd(static_cast<uint64_t>(a.toInt64()), static_cast<uint64_t>(b.toInt64())))};
+}
+
+BigDecimal lcm(const BigDecimal& lhs, const BigDecimal& rhs) {
+	requireFinite(lhs);
+	requireFinite(rhs);
+	if (!lhs.isInteger() || !rhs.isInteger()) {
+		fail<std::invalid_argument>("lcm needs integer arguments");
+	}
+	if (lhs.digits.empty() || rhs.digits.empty()) {
+		return {};
+	}
+	BigDecimal result = lhs / BigDecimal::Divisor{gcd(lhs, rhs)} * rhs;
+	result.sign = true;
+	return result;
+}
+
+bool BigDecimal::isDivisibleBy(const BigDecimal& divisor) const {
+	requireFinite(*this);
+	requireFinite(divisor);
+	if (divisor.digits.empty()) {
+		fail<std::domain_error>("Division by zero");
+	}
+	return (*this % Divisor{divisor}).digits.empty();
+}
+
+namespace {
+	const BigDecimal& positiveInteger(const BigDecimal& bd) {
+		if (!(bd > 0 && bd.isInteger())) {
+			fail<std::invalid_argument>("Modulus must be a positive integer");
+		}
+		return bd;
+	}
+}
+
+BigDecimal::Modulus::Modulus(const BigDecimal& bd) : divisor(positiveInteger(bd)) {}
+
+BigDecimal BigDecimal::Modulus::reduce(const BigDecimal& bd) const {
+	if (!bd.isInteger()) {
+		fail<std::invalid_argument>("Modular arithmetic needs integer arguments");
+	}
+	BigDecimal result = bd % divisor;
+	if (!result.sign) {
+		result += value();
+	}
+	return result;
+}
+
+BigDecimal BigDecimal::Modulus::mulmod(const BigDecimal& lhs, const BigDecimal& rhs) const {
+	return reduce(reduce(lhs) * reduce(rhs));
+}
+
+BigDecimal BigDecimal::Modulus::powmod(const BigDecimal& base, const BigDecimal& exponent) const {
+	if (!exponent.isInteger() || !exponent.sign) {
+		fail<std::invalid_argument>("powmod needs a non-negative integer exponent");
+	}
+	//Left to right over the exponent's decimal digits: result = result^10 * base^digit
+	std::vector<BigDecimal> powers{reduce(1), reduce(base)};
+	for (int i = 2; i < 10; i++) {
+		powers.push_back(reduce(powers.back() * powers[1]));
+	}
+	BigDecimal result = powers[0];
+	for (int position = static_cast<int>(exponent.digits.size()) + exponent.exponent - 1; position >= 0; position--) {
+		BigDecimal squared = reduce(result.square());
+		result = reduce(reduce(squared.square()) * result);
+		result = reduce(result.square());
+		int index = position - exponent.exponent;
+		if (index >= 0 && exponent.digits[index] != '0') {
+			result = reduce(result * powers[exponent.digits[index] - '0']);
+		}
+	}
+	return result;
+}
+
+namespace {
+	//How many times prime divides a normalized coefficient, read from its last 18 digits (which decide it modulo
+	//prime^18); empty when those are all divisible and the rest of the digits would be needed
+	std::optional<int> valuation(const std::vector<char>& digits, uint64_t prime) {
+		size_t count = std::min<size_t>(digits.size(), 18);
+		uint64_t low = 0;
+		for (size_t i = count; i-- > 0;) {
+			low = low * 10 + static_cast<uint64_t>(digits[i] - '0');
+		}
+		int result = 0;
+		for (; low != 0 && low % prime == 0; low /= prime) {
+			result++;
+		}
+		if (count < digits.size() && result >= static_cast<int>(count)) {
+			return std::nullopt;
+		}
+		return result;
+	}
+}
+
+BigDecimal::Context::Context(int precision) : digits(precision) {
+	if (precision < 1) {
+		fail<std::invalid_argument>("precision must be at least 1");
+	}
+}
+
+BigDecimal BigDecimal::Context::finish(BigDecimal result, int64_t shift) {
+	if (result.digits.size() > static_cast<size_t>(digits)) {
+		status |= inexact;
+		result.round(digits);
+	}
+	if (result.digits.empty()) {
+		return result;
+	}
+	int64_t exponent = result.exponent + shift;
+	if (exponent > std::numeric_limits<int>::max()) {
+		status |= overflow | inexact;
+		return infinity(!result.sign);
+	}
+	if (exponent < std::numeric_limits<int>::min()) {
+		status |= inexact;
+		return BigDecimal{};
+	}
+	result.exponent = static_cast<int>(exponent);
+	return result;
+}
+
+BigDecimal BigDecimal::Context::add(const BigDecimal& lhs, const BigDecimal& rhs) {
+	if (isSpecialCase(lhs, rhs, '+')) {
+		return specialResult(lhs, rhs, '+', &status);
+	}
+	auto lead = [](const BigDecimal& bd) { return static_cast<int64_t>(bd.exponent) + static_cast<int64_t>(bd.digits.size()); };
+	bool lhsLarger = rhs.digits.empty() || (!lhs.digits.empty() && lead(lhs) >= lead(rhs));
+	const BigDecimal& larger = lhsLarger ? lhs : rhs;
+	const BigDecimal& smaller = lhsLarger ? rhs : lhs;
+	//Everything of the smaller operand below both the rounding digit and the larger operand's last digit only
+	//decides which way the result rounds, so one sticky digit stands in for it and the sum stays short
+	int64_t k = std::min(lead(larger) - digits - 2, static_cast<int64_t>(larger.exponent));
+	if (!smaller.digits.empty() && lead(smaller) < k && k - 2 >= std::numeric_limits<int>::min()) {
+		BigDecimal sticky{};
+		sticky.digits.push_back('1');
+		sticky.sign = smaller.sign;
+		sticky.exponent = static_cast<int>(k - 2);
+		return finish(larger + sticky, 0);
+	}
+	return finish(lhs + rhs, 0);
+}
+
+BigDecimal BigDecimal::Context::subtract(const BigDecimal& lhs, const BigDecimal& rhs) {
+	if (isSpecialCase(lhs, rhs, '-')) {
+		return specialResult(lhs, rhs, '-', &status);
+	}
+	BigDecimal negated = rhs;
+	if (!negated.digits.empty()) {
+		negated.sign = !negated.sign;
+	}
+	return add(lhs, negated);
+}
+
+BigDecimal BigDecimal::Context::multiply(const BigDecimal& lhs, const BigDecimal& rhs) {
+	if (isSpecialCase(lhs, rhs, '*')) {
+		return specialResult(lhs, rhs, '*', &status);
+	}
+	//The exponents are added separately so an out of range one is flagged rather than wrapping
+	BigDecimal product = lhs;
+	BigDecimal factor = rhs;
+	product.exponent = 0;
+	factor.exponent = 0;
+	int64_t shift = static_cast<int64_t>(lhs.exponent) + rhs.exponent;
+	if (lhs.digits.empty() || rhs.digits.empty()) {
+		return BigDecimal{};
+	}
+	//The exact product has n + m - 1 or n + m digits, and its trailing zeroes come from the factors of 2 and 5 in
+	//each coefficient, so whether rounding drops anything is known without the low half of the product
+	std::optional<int> twos = valuation(lhs.digits, 2);
+	std::optional<int> fives = valuation(lhs.digits, 5);
+	std::optional<int> rhsTwos = valuation(rhs.digits, 2);
+	std::optional<int> rhsFives = valuation(rhs.digits, 5);
+	if (twos && fives && rhsTwos && rhsFives) {
+		auto trailingZeroes = static_cast<size_t>(std::min(*twos + *rhsTwos, *fives + *rhsFives));
+		if (lhs.digits.size() + rhs.digits.size() - 1 - trailingZeroes > static_cast<size_t>(digits)) {
+			status |= inexact;
+			return finish(::multiply(product, factor, digits), shift);
+		}
+	}
+	//The product has at most digits + 1 significant digits and a few dozen trailing zeroes, so it costs about what
+	//the short product would; or a coefficient ends in 18 digits all divisible by 2 or by 5, which is rare enough
+	//to do exactly
+	product *= factor;
+	return finish(std::move(product), shift);
+}
+
+BigDecimal BigDecimal::Context::divide(const BigDecimal& lhs, const BigDecimal& rhs) {
+	if (isSpecialCase(lhs, rhs, '/')) {
+		return specialResult(lhs, rhs, '/', &status);
+	}
+	BigDecimal dividend = lhs;
+	BigDecimal divisor = rhs;
+	dividend.exponent = 0;
+	divisor.exponent = 0;
+	bool exact = true;
+	BigDecimal quotient = divideReporting(dividend, divisor, digits, &exact);
+	if (!exact) {
+		status |= inexact;
+	}
+	return finish(std::move(quotient), static_cast<int64_t>(lhs.exponent) - rhs.exponent);
+}
+
+int64_t BigDecimal::Context::toInt64(const BigDecimal& bd, Rounding mode) {
+	if (bd.isNaN()) {
+		status |= invalid;
+		return 0;
+	}
+	std::optional<int64_t> result = bd.tryToInt64(mode);
+	if (!result) {
+		status |= invalid;
+		return bd.sign ? std::numeric_limits<int64_t>::max() : std::numeric_limits<int64_t>::min();
+	}
+	if (!bd.isInteger()) {
+		status |= inexact;
+	}
+	return *result;
+}
+
+namespace {
+	//An output iterator that gathers characters in a block on the stack and hands each full block to the stream
+	//buffer with one sputn, rather than a virtual sputc per character
+	class BlockWriter {
+	public:
+		using iterator_category = std::output_iterator_tag;
+		using value_type = void;
+		using difference_type = ptrdiff_t;
+		using pointer = void;
+		using reference = void;
+		struct Block {
+			std::streambuf* target;
+			std::array<char, 256> chars{};
+			std::streamsize used{0};
+			bool failed{false};
+			void flush() {
+				failed = failed || target->sputn(chars.data(), used) != used;
+				used = 0;
+			}
+		};
+		explicit BlockWriter(Block& block) : block(&block) {}
+		BlockWriter& operator=(char c) {
+			if (block->used == static_cast<std::streamsize>(block->chars.size())) {
+				block->flush();
+			}
+			block->chars[static_cast<size_t>(block->used++)] = c;
+			return *this;
+		}
+		BlockWriter& operator*() { return *this; }
+		BlockWriter& operator++() { return *this; }
+		BlockWriter operator++(int) { return *this; }
+	private:
+		Block* block;
+	};
+}
+
+std::ostream& operator<<(std::ostream& out, const BigDecimal& bd) {
+    std::ostream::sentry sentry(out);
+    if (!sentry) {
+        return out;
+    }
+    //The pieces go into the stream buffer in blocks, padded as the stream's width, fill and adjustment ask
+    BigDecimal::FormatSpec spec{};
+    spec.fill = out.fill();
+    spec.align = (out.flags() & std::ios::adjustfield) == std::ios::left ? '<' : '>';
+    spec.sign = (out.flags() & std::ios::showpos) ? '+' : '-';
+    spec.width = static_cast<int>(std::min<std::streamsize>(out.width(), std::numeric_limits<int>::max()));
+    out.width(0);
+    BlockWriter::Block block{out.rdbuf()};
+    bd.formatTo(BlockWriter{block}, spec);
+    block.flush();
+    if (block.failed) {
+        out.setstate(std::ios::badbit);
+    }
+    return out;
+}
+
+std::istream& operator>>(std::istream& in, BigDecimal& bd) {
+    std::istream::sentry sentry(in);
+    bd = {};
+    if (!sentry) {
+        return in;
+    }
+    //Reads one whitespace delimited token, at most width() characters of it, and hands it through a small buffer to
+    //the grammar from_chars uses; anything that isn't a decimal makes the whole token fail, like the string constructor would
+    const auto& ctype = std::use_facet<std::ctype<char>>(in.getloc());
+    std::streambuf* buffer = in.rdbuf();
+    std::streamsize width = in.width();
+    std::streamsize count = 0;
+    BigDecimal::Scanner scanner;
+    std::array<char, 64> block;
+    size_t blockSize = 0;
+    int c = buffer->sgetc();
+    for (; c != std::char_traits<char>::eof() && (width <= 0 || count < width) && !ctype.is(std::ctype_base::space, static_cast<char>(c)); c = buffer->snextc()) {
+        block[blockSize++] = static_cast<char>(c);
+        count++;
+        if (blockSize == block.size()) {
+            scanner.scan(block.data(), block.data() + blockSize);
+            blockSize = 0;
+        }
+    }
+    scanner.scan(block.data(), block.data() + blockSize);
+    in.width(0);
+    if (c == std::char_traits<char>::eof()) {
+        in.setstate(std::ios::eofbit);
+    }
+    if (scanner.accepted() != static_cast<size_t>(count) || scanner.finish(bd) != std::errc{}) {
+        in.setstate(std::ios::failbit);
+    }
+    return in;
 }
\ No newline at end of file
@@ -1,65 +1,1205 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <compare>
+#include <cstdint>
+#include <cstddef>
+#include <concepts>
+#include <utility>
+#include <span>
+#include <string_view>
+#include <charconv>
+#include <optional>
+#include <cstdlib>
+#include <array>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <stdexcept>
+#if __has_include(<expected>)
+#include <expected>
+#endif
+#if __has_include(<format>)
+#include <format>
+#endif
 
 class BigDecimal {
 public:
+	class Divisor;
+	class Modulus;
+	class Context;
+	//How conversions to integers treat a fractional part
+	enum class Rounding { towardZero, floor, ceiling, halfEven, halfAwayFromZero };
 	BigDecimal() = default;
+	//Construction, comparison and + - * / % are constexpr, so constants can be built and checked at compile time
+	//(the digits live in a std::vector, so a BigDecimal itself can't outlive constant evaluation; see operator""_bd)
 	//Implicit conversions
-	BigDecimal(long long);
-	BigDecimal(long);
-	BigDecimal(int);
-	BigDecimal(short);
-	BigDecimal(char);
+	constexpr BigDecimal(long long);
+	constexpr BigDecimal(long);
+	constexpr BigDecimal(int);
+	constexpr BigDecimal(short);
+	constexpr BigDecimal(char);
+	//Floating point values are rounded (half to even) to precision + 1 significant digits of their exact value
+	//Infinities and NaNs throw std::invalid_argument, here and in exact and shortest
     BigDecimal(float, int precision = 7);
 	BigDecimal(double, int precision = 15);
 	BigDecimal(long double, int precision = 15);
+	//The exact value of a binary floating point number, which can run to hundreds of digits
+	static BigDecimal exact(long double);
+	//The fewest significant digits that convert back to the same floating point value
+	static BigDecimal shortest(float);
+	static BigDecimal shortest(double);
+	static BigDecimal shortest(long double);
+	//IEEE 754 style special values. They only come out of operations that were given one, or of a Context; with finite
+	//operands everything keeps throwing as before. Arithmetic and comparisons handle them, as do the conversions,
+	//which print "inf", "-inf" and "nan" and read those back; the other functions throw std::domain_error for them
+	static constexpr BigDecimal infinity(bool negative = false);
+	static constexpr BigDecimal nan();
+	constexpr bool isFinite() const;
+	constexpr bool isInfinite() const;
+	constexpr bool isNaN() const;
 	//Explicit conversions
-	explicit BigDecimal(const std::string&);
-	explicit BigDecimal(const char*);
-	//Throws an exception if it can't fit, and truncates everything after the decimal point
-	int64_t toInt64();
-	//can lose information
-	long double toLongDouble();
+	//Throw std::invalid_argument for malformed input and std::out_of_range for exponents that don't fit in an int
+	explicit constexpr BigDecimal(std::string_view);
+	explicit constexpr BigDecimal(const std::string&);
+	explicit constexpr BigDecimal(const char*);
+	//Why parse turned its input down
+	enum class ParseError { invalidSyntax, exponentOutOfRange };
+	//std::expected<BigDecimal, ParseError> where the standard library has it, otherwise a stand-in with the same interface
+#ifdef __cpp_lib_expected
+	using ParseResult = std::expected<BigDecimal, ParseError>;
+#else
+	class ParseResult;
+#endif
+	//The string constructor without exceptions, for input that's expected to be bad some of the time
+	static ParseResult parse(std::string_view);
+	//Round to an integer as mode says, then throw std::overflow_error (or std::underflow_error for negative values)
+	//if the result doesn't fit. Only the integer digits are ever read, so the cost doesn't depend on the precision
+	int64_t toInt64(Rounding mode = Rounding::towardZero) const;
+	uint64_t toUint64(Rounding mode = Rounding::towardZero) const;
+	//The same, but empty instead of throwing
+	std::optional<int64_t> tryToInt64(Rounding mode = Rounding::towardZero) const;
+	std::optional<uint64_t> tryToUint64(Rounding mode = Rounding::towardZero) const;
+#ifdef __SIZEOF_INT128__
+	__int128 toInt128(Rounding mode = Rounding::towardZero) const;
+	std::optional<__int128> tryToInt128(Rounding mode = Rounding::towardZero) const;
+#endif
+	//Correctly rounded (to nearest, ties to even); too large gives an infinity and too small a zero of the same sign
+	double toDouble() const;
+	float toFloat() const;
+	long double toLongDouble() const;
 	//Doesn't lose information, but still shouldn't be implicit
 	std::string toString() const;
+	//Exactly how many characters to_chars writes for this value in the given format
+	size_t formattedSize(std::chars_format format = std::chars_format::general) const;
+	//A std::format style specification: [[fill]align][sign][0][width][.precision][type]
+	//type is 'f' (fixed), 'e' (scientific), 'n' (engineering, exponent a multiple of three) or 'g'/none (toString's format).
+	//precision is digits after the point for 'f', digits after the first for 'e' and 'n', and significant digits for 'g';
+	//without one the value is written exactly. Numbers are right aligned by default
+	struct FormatSpec {
+		char fill{' '};
+		char align{'\0'};
+		char sign{'-'};
+		bool zeroPad{false};
+		int width{0};
+		int precision{-1};
+		char type{'\0'};
+		//Returns how many characters were consumed, stopping at '}' or the end, or std::string_view::npos if malformed
+		constexpr size_t parse(std::string_view text);
+	};
+	//Writes the value through out as spec describes, returning the iterator past the last character written
+	template<typename Out>
+	Out formatTo(Out out, const FormatSpec& spec) const;
+	//std::formatter<BigDecimal>'s parse and format, for any contexts with begin(), end() and out() like the standard's
+	struct Formatter;
+	//Compact binary form: a varint holding the sign and exponent (or which special value this is), then for finite
+	//values a varint digit count and the digits three at a time in 10 bit groups, about 0.42 bytes per digit.
+	//The encoding is canonical, so equal values always give equal bytes
+	size_t serializedSize() const;
+	//Returns the number of bytes written, or 0, writing nothing, if out is shorter than serializedSize()
+	size_t serialize(std::span<std::byte> out) const;
+	//Reads one value from the front of in, returning how many bytes it used, or 0 (leaving value unchanged) if in
+	//doesn't start with a well-formed encoding. Never throws
+	static size_t deserialize(std::span<const std::byte> in, BigDecimal& value);
+	//An order preserving key: comparing two keys with memcmp (or std::lexicographical_compare on unsigned bytes)
+	//agrees with operator<=>, special values included. Keys are self-delimiting, so a key followed by more bytes still
+	//sorts by its value first, which suits composite keys in sorted stores. The same return conventions as serialize
+	size_t keySize() const;
+	size_t encodeKey(std::span<std::byte> out) const;
+	static size_t decodeKey(std::span<const std::byte> in, BigDecimal& value);
+	//True if there are no non-zero digits after the decimal point
+	constexpr bool isInteger() const;
+	//True if divisor goes into this a whole number of times; throws std::domain_error for a zero divisor
+	bool isDivisibleBy(const BigDecimal& divisor) const;
 	//copy and move constructors are implicitly defined to be member-wise, which is fine here
 	//member operators
-	BigDecimal& operator+=(const BigDecimal&);
-	BigDecimal& operator-=(const BigDecimal&);
-	BigDecimal& operator*=(const BigDecimal&);
+	constexpr BigDecimal& operator+=(const BigDecimal&);
+	constexpr BigDecimal& operator-=(const BigDecimal&);
+	//At compile time this is plain schoolbook multiplication; the faster kernels only run at run time
+	constexpr BigDecimal& operator*=(const BigDecimal&);
+	//Equivalent to *this * *this, but each cross product is only computed once
+	BigDecimal square() const;
+	//Rounds to the given number of significant digits, half to even
+	BigDecimal& round(int precision);
+	//The same rounding into a new value, copying only the digits that are kept
+	BigDecimal rounded(int precision) const;
+	//Constants correctly rounded (half to even) to the given number of significant digits
+	//Each is computed once at the highest precision asked for so far and shared between threads, so repeated calls only round
+	static BigDecimal pi(int precision);
+	static BigDecimal e(int precision);
+	static BigDecimal ln2(int precision);
+	static BigDecimal ln10(int precision);
     //Passing by value as copies have to be made anyway
-	BigDecimal& operator/=(BigDecimal);
-	BigDecimal& operator%=(BigDecimal);
-	BigDecimal& operator++(); //prefix
-	const BigDecimal operator++(int);//postfix
-	BigDecimal& operator--(); //prefix
-	const BigDecimal operator--(int); //postfix
+	constexpr BigDecimal& operator/=(BigDecimal);
+	constexpr BigDecimal& operator%=(BigDecimal);
+	constexpr BigDecimal& operator++(); //prefix
+	constexpr const BigDecimal operator++(int);//postfix
+	constexpr BigDecimal& operator--(); //prefix
+	constexpr const BigDecimal operator--(int); //postfix
 	//friend operators (to allow argument symmetry via ADL lookup)
 	//First argument is passed by value to prevent having to create a new copy
-	friend BigDecimal operator+(BigDecimal, const BigDecimal&);
-	friend BigDecimal operator-(BigDecimal, const BigDecimal&);
-	friend BigDecimal operator*(BigDecimal, const BigDecimal&);
-	friend BigDecimal operator/(BigDecimal, BigDecimal);
-	friend BigDecimal operator%(BigDecimal, BigDecimal);
+	friend constexpr BigDecimal operator+(BigDecimal, const BigDecimal&);
+	friend constexpr BigDecimal operator-(BigDecimal, const BigDecimal&);
+	friend constexpr BigDecimal operator*(BigDecimal, const BigDecimal&);
+	friend constexpr BigDecimal operator/(BigDecimal, BigDecimal);
+	friend constexpr BigDecimal operator%(BigDecimal, BigDecimal);
+	//Negation; zero and NaN are unchanged
+	friend constexpr BigDecimal operator-(BigDecimal);
+	//Correctly rounded (half to even) product to the given number of significant digits
+	//Only computes the columns that can affect the rounded result, about half the work of a full product
+	friend BigDecimal multiply(const BigDecimal&, const BigDecimal&, int precision);
+	//Correctly rounded (half to even) quotient to the given number of significant digits
+	//Throws std::domain_error when dividing by zero
+	friend BigDecimal divide(const BigDecimal&, const BigDecimal&, int precision);
+	//The same, but empty instead of throwing: for a zero divisor, a precision below 1, or an exponent out of range
+	friend std::optional<BigDecimal> tryDivide(const BigDecimal&, const BigDecimal&, int precision);
+	//Horner's scheme, with coefficients[i] multiplying x^i; each step is one fused multiply-add into the same accumulator
+	//precision 0 means an exact result. Otherwise every step keeps a few guard digits and the result is rounded to
+	//precision significant digits, which is correctly rounded unless the terms cancel heavily
+	friend BigDecimal evaluatePolynomial(std::span<const BigDecimal> coefficients, const BigDecimal& x, int precision);
+	//Evaluates at every point, converting the coefficients only once
+	friend std::vector<BigDecimal> evaluatePolynomial(std::span<const BigDecimal> coefficients, std::span<const BigDecimal> xs, int precision);
+	friend BigDecimal pow(const BigDecimal& base, int64_t exponent, int precision);
+	//Correctly rounded (half to even) roots to the given number of significant digits
+	//Throws std::domain_error for even roots of negative numbers
+	friend BigDecimal sqrt(const BigDecimal&, int precision);
+	friend BigDecimal root(const BigDecimal&, int n, int precision);
+	//Correctly rounded (half to even) to the given number of significant digits, except that a result lying exactly
+	//halfway between two roundings may come out either way. log and log10 throw std::domain_error for x <= 0.
+	//exp and the real pow throw std::overflow_error or std::underflow_error when the result's decimal exponent would
+	//be past about +-2^30
+	friend BigDecimal exp(const BigDecimal&, int precision);
+	friend BigDecimal log(const BigDecimal&, int precision);
+	friend BigDecimal log10(const BigDecimal&, int precision);
+	//Integer exponents that fit in int64_t go through the integer overload; otherwise base must be non-negative
+	friend BigDecimal pow(const BigDecimal& base, const BigDecimal& exponent, int precision);
+	//Correctly rounded (half to even) to the given number of significant digits; arguments are in radians.
+	//Arguments are reduced by a multiple of pi / 2 with enough digits of pi to survive the cancellation
+	friend BigDecimal sin(const BigDecimal&, int precision);
+	friend BigDecimal cos(const BigDecimal&, int precision);
+	friend BigDecimal tan(const BigDecimal&, int precision);
+	friend BigDecimal atan(const BigDecimal&, int precision);
+	//Non-negative greatest common divisor and least common multiple of integers; throw std::invalid_argument otherwise
+	//gcd runs Lehmer's algorithm, so most steps are word-sized arithmetic on the leading digits
+	friend BigDecimal gcd(const BigDecimal&, const BigDecimal&);
+	friend BigDecimal lcm(const BigDecimal&, const BigDecimal&);
+	//Same results as dividing by divisor.value(), but reusing the precomputed reciprocal
+	friend BigDecimal operator/(const BigDecimal&, const Divisor&);
+	friend BigDecimal operator%(const BigDecimal&, const Divisor&);
 	//== can be default; all member variables have equality, so default equals check is fine
 	friend bool operator==(const BigDecimal&, const BigDecimal&) = default;
 	//<=> cannot be default, as digits are stored in reverse order
 	//<=> is similar to compareTo in Java
-	friend std::strong_ordering operator<=>(const BigDecimal&, const BigDecimal&);
+	//Special values are totally ordered: -infinity < every finite value < infinity < NaN, and NaN == NaN
+	friend constexpr std::strong_ordering operator<=>(const BigDecimal&, const BigDecimal&);
+	//Parses the longest prefix of [first, last) that's a decimal, or inf, infinity or nan (signed, in any case), like
+	//std::from_chars: returns the end of it and std::errc{} on success. On errc::invalid_argument (no number at first)
+	//or errc::result_out_of_range (the exponent doesn't fit in an int), value is left unchanged. Never throws
+	friend constexpr std::from_chars_result from_chars(const char* first, const char* last, BigDecimal& value);
+	//Writes the value into [first, last) with no allocation, returning the end of what was written. general is toString's
+	//format, fixed never uses an exponent, and scientific always does, with one digit before the point
+	//Fails with errc::value_too_large if the buffer is shorter than formattedSize(format), or errc::invalid_argument for hex
+	friend std::to_chars_result to_chars(char* first, char* last, const BigDecimal& bd);
+	friend std::to_chars_result to_chars(char* first, char* last, const BigDecimal& bd, std::chars_format format);
     //Stream operators
     friend std::ostream& operator<<(std::ostream&, const BigDecimal&);
     friend std::istream& operator>>(std::istream&, BigDecimal&);
 private:
 	std::vector<char> digits{};
 	bool sign{true};
+	//Infinities and NaNs have no digits and an exponent of 0; sign tells the infinities apart
+	enum class Kind : char { finite, infinity, nan };
+	Kind kind{Kind::finite};
 	int exponent{0};
 	//Ensure proper equality:
 	// no trailing zeroes or leading zeroes
 	// if this == 0 should be true, sign == true, exponent = 0, digits.clear()
-	void normalize();
-	void constructFromChars(std::string);
-	void doAdd(const BigDecimal&);
-	void doSubtract(const BigDecimal&);
-	static BigDecimal singleDigitMultiply(BigDecimal bd, int digit);
-};
\ No newline at end of file
+	constexpr void normalize();
+	//The IEEE 754 result of lhs op rhs, for op one of + - * / %, when either side isn't finite or a finite value is
+	//divided by zero. Whatever would raise an IEEE exception sets the Context flag in flags, if given
+	static constexpr BigDecimal specialResult(const BigDecimal& lhs, const BigDecimal& rhs, char op, unsigned* flags = nullptr);
+	static constexpr bool isSpecialCase(const BigDecimal& lhs, const BigDecimal& rhs, char op);
+	//Throws E, or aborts where exceptions are turned off. It's out of line, so reaching it during constant evaluation
+	//is a compile error: that's how a malformed literal or a constant division by zero gets reported
+	template<typename E>
+	[[noreturn]] static void raise(std::string_view message);
+	constexpr void constructFromChars(std::string_view);
+	//The text form read by from_chars and operator>>, built into a value as the characters come
+	class Scanner;
+	//The end of the run of ASCII digits starting at first; long runs are checked 16 or 32 bytes at a time
+	static const char* skipDigits(const char* first, const char* last);
+	constexpr void doAdd(const BigDecimal&);
+	constexpr void doSubtract(const BigDecimal&);
+	static constexpr std::strong_ordering compareMagnitude(const BigDecimal&, const BigDecimal&);
+	//The first varint of the serialized form: the zigzagged exponent shifted past two low bits, which are 0 for
+	//positive, 1 for negative and 2 for the special values, numbered 0 (infinity), 1 (-infinity) and 2 (NaN)
+	uint64_t serialTag() const;
+	//operator*= at run time, with the squaring and Karatsuba kernels
+	BigDecimal& multiplyAssign(const BigDecimal&);
+	//A literal's digits, parsed at compile time into storage that can outlive constant evaluation
+	template<size_t N>
+	struct Literal {
+		std::array<char, N> digits{};
+		size_t size{0};
+		bool sign{true};
+		int exponent{0};
+		consteval explicit Literal(std::array<char, N> text);
+		BigDecimal value() const;
+	};
+	template<char... chars>
+	friend BigDecimal operator""_bd();
+	//*this = *this * factor + addend, with the values being the digits as plain numbers so callers can convert them once
+	void multiplyAdd(const BigDecimal& factor, const std::vector<int64_t>& factorValues, const BigDecimal& addend, const std::vector<int64_t>& addendValues);
+	//Drops every digit below 10^position, rounding toward zero
+	void truncate(int position);
+	static BigDecimal powerOfTen(int);
+	//log10(|bd|) to about 18 digits, even where |bd| is out of long double's range; bd must be non-zero
+	static long double log10Magnitude(const BigDecimal& bd);
+	//divide, also reporting through exact (when it isn't null) whether any non-zero digits were rounded away
+	static BigDecimal divideReporting(const BigDecimal& lhs, const BigDecimal& rhs, int precision, bool* exact);
+	//Newton approximation of 1 / bd, good to about precision significant digits
+	static BigDecimal approximateReciprocal(const BigDecimal& bd, int precision);
+	//Good to a relative error of about 10^-precision, before any final rounding
+	static BigDecimal expApprox(const BigDecimal& x, int precision);
+	static BigDecimal logApprox(const BigDecimal& x, int precision);
+	//sin(x) and cos(x) together, as each is needed to combine the other across reduction steps
+	static std::pair<BigDecimal, BigDecimal> sinCosApprox(const BigDecimal& x, int precision);
+	static BigDecimal atanApprox(const BigDecimal& x, int precision);
+	//Correctly rounds the n-th root of radicand, given an estimate good to about precision + 2 digits
+	static BigDecimal roundRoot(const BigDecimal& radicand, int n, const BigDecimal& estimate, int precision);
+	template<std::floating_point T>
+	T toFloatingPoint() const;
+	//std::to_chars's shortest round trip for float and double; for long double, Ryu's search done with exact
+	//arithmetic: the fewest digits inside d's rounding interval, closest to d on a tie
+	template<std::floating_point T>
+	static BigDecimal shortestOf(T d);
+	//T is int64_t, uint64_t or __int128; the last isn't std::integral outside GNU modes
+	template<typename T>
+	std::optional<T> toInteger(Rounding mode) const;
+	//Formatted output as a short list of pieces, so it can be sized exactly before any of it is written
+	struct Layout {
+		struct Piece {
+			enum class Kind : char { digits, zeroes, character, exponent } kind;
+			//[first, second) of the digits, most significant first; the count of zeroes; the character; or the exponent
+			int64_t first;
+			int64_t second;
+		};
+		std::array<Piece, 10> pieces{};
+		size_t count{0};
+		size_t size{0};
+	};
+	//type and precision are FormatSpec's; rounding to precision is worked out from the digits in place
+	Layout layout(char type, int precision, char signMode) const;
+	template<typename Out>
+	Out writeLayout(Out out, const Layout& layout) const;
+};
+
+//Declared again outside the class so they're found for arguments that only convert to BigDecimal
+BigDecimal multiply(const BigDecimal&, const BigDecimal&, int precision);
+BigDecimal divide(const BigDecimal&, const BigDecimal&, int precision);
+std::optional<BigDecimal> tryDivide(const BigDecimal&, const BigDecimal&, int precision);
+BigDecimal evaluatePolynomial(std::span<const BigDecimal> coefficients, const BigDecimal& x, int precision = 0);
+std::vector<BigDecimal> evaluatePolynomial(std::span<const BigDecimal> coefficients, std::span<const BigDecimal> xs, int precision = 0);
+BigDecimal sqrt(const BigDecimal&, int precision);
+BigDecimal root(const BigDecimal&, int n, int precision);
+BigDecimal exp(const BigDecimal&, int precision);
+BigDecimal log(const BigDecimal&, int precision);
+BigDecimal log10(const BigDecimal&, int precision);
+BigDecimal pow(const BigDecimal& base, const BigDecimal& exponent, int precision);
+BigDecimal sin(const BigDecimal&, int precision);
+BigDecimal cos(const BigDecimal&, int precision);
+BigDecimal tan(const BigDecimal&, int precision);
+BigDecimal atan(const BigDecimal&, int precision);
+BigDecimal gcd(const BigDecimal&, const BigDecimal&);
+BigDecimal lcm(const BigDecimal&, const BigDecimal&);
+//Square and multiply; precision 0 means an exact result, except that negative exponents then divide like operator/
+//Otherwise the result is rounded to precision significant digits
+BigDecimal pow(const BigDecimal& base, int64_t exponent, int precision = 0);
+//A floating point exponent would otherwise silently convert to int64_t; pass a BigDecimal instead
+template<std::floating_point T>
+BigDecimal pow(const BigDecimal& base, T exponent, int precision = 0) = delete;
+
+//Exact products, built as balanced product trees so large arguments land in the Karatsuba multiplies
+//factorial uses the prime swing: n! == ((n / 2)!)^2 swing(n), with swing(n) assembled from its prime factorization
+BigDecimal factorial(int64_t n);
+//Zero when k < 0 or k > n >= 0; negative n follows C(n, k) == (-1)^k C(k - n - 1, k)
+BigDecimal binomial(int64_t n, int64_t k);
+//x (x + 1) ... (x + n - 1) and x (x - 1) ... (x - n + 1); both are 1 when n == 0
+BigDecimal risingFactorial(const BigDecimal& x, int64_t n);
+BigDecimal fallingFactorial(const BigDecimal& x, int64_t n);
+
+//A divisor prepared for repeated use: the value is split into an integer mantissa and an exponent,
+//and the mantissa's reciprocal is computed once so each division is a few multiplies plus a correction
+class BigDecimal::Divisor {
+public:
+	explicit Divisor(const BigDecimal&);
+	const BigDecimal& value() const { return divisor; }
+private:
+	BigDecimal divisor;
+	//divisor == mantissa * 10^exponent, with mantissa a positive integer
+	BigDecimal mantissa;
+	int exponent;
+	//Mantissas short enough for a machine word are divided directly
+	uint64_t smallMantissa{0};
+	//floor(10^(2n) / mantissa), where n is the number of digits in mantissa
+	BigDecimal reciprocal;
+	//numerator must be a non-negative integer; it's replaced by the remainder and the quotient is returned
+	BigDecimal divMod(BigDecimal& numerator) const;
+	friend BigDecimal operator/(const BigDecimal&, const Divisor&);
+	friend BigDecimal operator%(const BigDecimal&, const Divisor&);
+};
+
+//The grammar from_chars and operator>> share: [+-] digits [. [digits]] or [+-] . digits, then optionally (e|E) [+-] digits,
+//or one of [+-] inf, infinity and nan in any case, which is what output writes for the special values
+//Text can be fed in any number of pieces, so from_chars hands over its whole range and operator>> a block at a time
+class BigDecimal::Scanner {
+public:
+	//Takes as much of [first, last) as can continue the text so far, returning the end of that; once a character
+	//is refused, nothing more is taken
+	constexpr const char* scan(const char* first, const char* last);
+	//The length of the longest prefix taken so far that's a whole number
+	constexpr size_t accepted() const { return acceptedLength; }
+	//Moves that number into value, or fails with errc::invalid_argument if there's none, or errc::result_out_of_range
+	//if its exponent doesn't fit in an int, leaving value unchanged
+	constexpr std::errc finish(BigDecimal& value);
+private:
+	enum class Part : char { start, sign, integer, leadingPoint, fraction, exponentMarker, exponentSign, exponent, word };
+	Part part{Part::start};
+	bool stopped{false};
+	bool sign{true};
+	bool exponentSign{true};
+	size_t taken{0};
+	size_t acceptedLength{0};
+	//Most significant first, without the leading zeroes
+	std::vector<char> digits{};
+	int64_t fractionDigits{0};
+	int64_t exponent{0};
+	//For a special value, "infinity" or "nan", and how many of its letters have been matched
+	std::string_view word{};
+	size_t matched{0};
+};
+
+#ifndef __cpp_lib_expected
+//The part of std::expected's interface that parse's callers need, for standard libraries that don't have it yet
+class BigDecimal::ParseResult {
+public:
+	ParseResult(BigDecimal value) : result{std::move(value)} {}
+	explicit ParseResult(ParseError error) : failure{error}, failed{true} {}
+	bool has_value() const { return !failed; }
+	explicit operator bool() const { return !failed; }
+	//Like std::expected, value() reports reading a missing value (here as std::logic_error) and * doesn't check
+	const BigDecimal& value() const& {
+		if (failed) {
+			raise<std::logic_error>("parse failed, so there is no value");
+		}
+		return result;
+	}
+	BigDecimal&& value() && {
+		if (failed) {
+			raise<std::logic_error>("parse failed, so there is no value");
+		}
+		return std::move(result);
+	}
+	const BigDecimal& operator*() const& { return result; }
+	BigDecimal&& operator*() && { return std::move(result); }
+	const BigDecimal* operator->() const { return &result; }
+	BigDecimal value_or(BigDecimal fallback) const& { return failed ? std::move(fallback) : result; }
+	ParseError error() const { return failure; }
+	friend bool operator==(const ParseResult& lhs, const BigDecimal& rhs) { return !lhs.failed && lhs.result == rhs; }
+private:
+	BigDecimal result{};
+	ParseError failure{};
+	bool failed{false};
+};
+#endif
+
+//Arithmetic rounded (half to even) to a fixed number of significant digits that never throws. Invalid operations give
+//NaN, division by zero and overflow give infinities, and each records a sticky flag, so a whole batch can be run
+//straight through and the flags checked once at the end
+class BigDecimal::Context {
+public:
+	enum Flag : unsigned {
+		divisionByZero = 1,
+		//Some non-zero digits were rounded away
+		inexact = 2,
+		//The exponent left int's range; a result too small to represent becomes zero and is only inexact
+		overflow = 4,
+		//inf - inf, 0 * inf, 0 / 0, inf / inf, a remainder of infinity or by zero, or an integer conversion out of range
+		invalid = 8
+	};
+	//Throws std::invalid_argument for a precision below 1
+	explicit Context(int precision);
+	int precision() const { return digits; }
+	unsigned flags() const { return status; }
+	bool test(unsigned flag) const { return (status & flag) != 0; }
+	void clearFlags() { status = 0; }
+	BigDecimal add(const BigDecimal&, const BigDecimal&);
+	BigDecimal subtract(const BigDecimal&, const BigDecimal&);
+	BigDecimal multiply(const BigDecimal&, const BigDecimal&);
+	BigDecimal divide(const BigDecimal&, const BigDecimal&);
+	//NaN gives 0 and values out of range saturate, both flagging invalid; dropping a non-zero fraction flags inexact
+	int64_t toInt64(const BigDecimal&, Rounding mode = Rounding::towardZero);
+private:
+	int digits;
+	unsigned status{0};
+	//Rounds an exact finite result and moves its exponent by shift, flagging what that did
+	BigDecimal finish(BigDecimal result, int64_t shift);
+};
+
+//Modular arithmetic on integers against a fixed positive integer modulus
+//Every reduction goes through the modulus' precomputed Divisor, so there's no long division per call
+class BigDecimal::Modulus {
+public:
+	explicit Modulus(const BigDecimal&);
+	const BigDecimal& value() const { return divisor.value(); }
+	//All of these throw std::invalid_argument for non-integer arguments, and return a value in [0, modulus)
+	BigDecimal reduce(const BigDecimal&) const;
+	BigDecimal mulmod(const BigDecimal&, const BigDecimal&) const;
+	//exponent must be non-negative
+	BigDecimal powmod(const BigDecimal& base, const BigDecimal& exponent) const;
+private:
+	Divisor divisor;
+};
+
+constexpr BigDecimal::BigDecimal(long long i) {
+	sign = i >= 0;
+	while (i != 0) {
+		digits.push_back(static_cast<char>('0' + (i < 0 ? -(i % 10) : i % 10)));
+		i /= 10;
+	}
+	normalize();
+}
+
+constexpr BigDecimal::BigDecimal(long i) : BigDecimal(static_cast<long long>(i)) {}
+constexpr BigDecimal::BigDecimal(int i) : BigDecimal(static_cast<long long>(i)) {}
+constexpr BigDecimal::BigDecimal(short i) : BigDecimal(static_cast<long long>(i)) {}
+constexpr BigDecimal::BigDecimal(char i) : BigDecimal(static_cast<long long>(i)) {}
+
+constexpr BigDecimal::BigDecimal(std::string_view chars) {
+	constructFromChars(chars);
+}
+
+constexpr BigDecimal::BigDecimal(const std::string& str) : BigDecimal(std::string_view{str}) {}
+
+constexpr BigDecimal::BigDecimal(const char* chars) : BigDecimal(std::string_view{chars}) {}
+
+constexpr void BigDecimal::constructFromChars(std::string_view chars) {
+	if (chars.empty()) {
+		return;
+	}
+	const char* last = chars.data() + chars.size();
+	auto [end, error] = from_chars(chars.data(), last, *this);
+	if (error == std::errc::result_out_of_range) {
+		raise<std::out_of_range>(std::string("\"") + std::string(chars) + "\" has an exponent out of range");
+	}
+	if (error != std::errc{} || end != last) {
+		raise<std::invalid_argument>(std::string("\"") + std::string(chars) + "\" is not a valid decimal");
+	}
+}
+
+constexpr const char* BigDecimal::Scanner::scan(const char* first, const char* last) {
+	auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+	//The vectorized digit scan can't run at compile time
+	auto skip = [&](const char* iter) {
+		if (std::is_constant_evaluated()) {
+			return std::find_if_not(iter, last, isDigit);
+		}
+		return BigDecimal::skipDigits(iter, last);
+	};
+	//Past this, the exponent can only be out of range, so it just needs to stop growing
+	constexpr int64_t exponentLimit = int64_t{1} << 40;
+	const char* iter = first;
+	while (iter != last && !stopped) {
+		char c = *iter;
+		if (isDigit(c) && part <= Part::fraction) {
+			//A run of digits never changes the part, so it's taken as one block; leading zeroes are dropped as
+			//they come and trailing ones once the number is finished
+			const char* runEnd = iter + 1 != last && isDigit(iter[1]) ? skip(iter + 2) : iter + 1;
+			if (part == Part::start || part == Part::sign) {
+				part = Part::integer;
+			}
+			else if (part == Part::leadingPoint) {
+				part = Part::fraction;
+			}
+			fractionDigits += part == Part::fraction ? runEnd - iter : 0;
+			const char* significant = digits.empty() ? std::find_if(iter, runEnd, [](char d) { return d != '0'; }) : iter;
+			//Looking past a point to the fraction's digits lets both runs be stored with one allocation
+			if (part == Part::integer && runEnd != last && *runEnd == '.') {
+				digits.reserve(digits.size() + static_cast<size_t>(skip(runEnd + 1) - significant));
+			}
+			digits.insert(digits.end(), significant, runEnd);
+			iter = runEnd;
+		}
+		else if (isDigit(c) && part != Part::word) {
+			part = Part::exponent;
+			exponent = std::min(exponentLimit, exponent * 10 + (c - '0'));
+			iter++;
+		}
+		else if ((c == '-' || c == '+') && (part == Part::start || part == Part::exponentMarker)) {
+			(part == Part::start ? sign : exponentSign) = c == '+';
+			part = part == Part::start ? Part::sign : Part::exponentSign;
+			iter++;
+		}
+		else if (c == '.' && part <= Part::integer) {
+			part = part == Part::integer ? Part::fraction : Part::leadingPoint;
+			iter++;
+		}
+		else if ((c == 'e' || c == 'E') && (part == Part::integer || part == Part::fraction)) {
+			part = Part::exponentMarker;
+			iter++;
+		}
+		//Setting the 0x20 bit lowercases ASCII letters, and nothing else lands on a lowercase letter
+		else if (part <= Part::sign && ((c | 0x20) == 'i' || (c | 0x20) == 'n')) {
+			word = (c | 0x20) == 'i' ? "infinity" : "nan";
+			matched = 1;
+			part = Part::word;
+			iter++;
+		}
+		else if (part == Part::word && matched < word.size() && (c | 0x20) == word[matched]) {
+			matched++;
+			iter++;
+		}
+		else {
+			stopped = true;
+			break;
+		}
+		//Like std::from_chars, an 'e' without digits after it isn't part of the number, and "infinit" is read as "inf"
+		if (part == Part::integer || part == Part::fraction || part == Part::exponent || (part == Part::word && (matched == 3 || matched == word.size()))) {
+			acceptedLength = taken + static_cast<size_t>(iter - first);
+		}
+	}
+	taken += static_cast<size_t>(iter - first);
+	return iter;
+}
+
+constexpr std::errc BigDecimal::Scanner::finish(BigDecimal& value) {
+	if (acceptedLength == 0) {
+		return std::errc::invalid_argument;
+	}
+	if (part == Part::word) {
+		value = word == "nan" ? BigDecimal::nan() : BigDecimal::infinity(!sign);
+		return std::errc{};
+	}
+	if (digits.empty()) {
+		value = BigDecimal{};
+		return std::errc{};
+	}
+	auto lastNonZero = std::find_if(digits.rbegin(), digits.rend(), [](char d) { return d != '0'; });
+	int64_t trailingZeroes = lastNonZero - digits.rbegin();
+	int64_t resultExponent = (exponentSign ? exponent : -exponent) + trailingZeroes - fractionDigits;
+	if (resultExponent > std::numeric_limits<int>::max() || resultExponent < std::numeric_limits<int>::min()) {
+		return std::errc::result_out_of_range;
+	}
+	digits.erase(lastNonZero.base(), digits.end());
+	std::reverse(digits.begin(), digits.end());
+	value = BigDecimal{};
+	value.digits = std::move(digits);
+	value.sign = sign;
+	value.exponent = static_cast<int>(resultExponent);
+	return std::errc{};
+}
+
+constexpr std::from_chars_result from_chars(const char* first, const char* last, BigDecimal& value) {
+	BigDecimal::Scanner scanner;
+	scanner.scan(first, last);
+	std::errc error = scanner.finish(value);
+	return {error == std::errc::invalid_argument ? first : first + scanner.accepted(), error};
+}
+
+constexpr void BigDecimal::normalize() {
+	//Digits are stored least significant to most, so leading zeroes are significant, trailing zeroes are not
+	//Remove trailing zeroes
+	for (int i = static_cast<int>(digits.size()) - 1; i >= 0 && digits.at(i) == '0'; i--) {
+		digits.pop_back();
+	}
+	//Ensure equality at 0
+	if (digits.empty()) {
+		sign = true;
+		exponent = 0;
+		return;
+	}
+	//Remove leading zeroes
+	auto firstNonZero = std::find_if(digits.begin(), digits.end(), [](char c) {return c != '0'; });
+	exponent += static_cast<int>(firstNonZero - digits.begin());
+	digits.erase(digits.begin(), firstNonZero);
+}
+
+constexpr bool BigDecimal::isInteger() const {
+	return kind == Kind::finite && exponent >= 0;
+}
+
+constexpr BigDecimal BigDecimal::infinity(bool negative) {
+	BigDecimal result{};
+	result.kind = Kind::infinity;
+	result.sign = !negative;
+	return result;
+}
+
+constexpr BigDecimal BigDecimal::nan() {
+	BigDecimal result{};
+	result.kind = Kind::nan;
+	return result;
+}
+
+constexpr bool BigDecimal::isFinite() const {
+	return kind == Kind::finite;
+}
+
+constexpr bool BigDecimal::isInfinite() const {
+	return kind == Kind::infinity;
+}
+
+constexpr bool BigDecimal::isNaN() const {
+	return kind == Kind::nan;
+}
+
+constexpr bool BigDecimal::isSpecialCase(const BigDecimal& lhs, const BigDecimal& rhs, char op) {
+	return lhs.kind != Kind::finite || rhs.kind != Kind::finite || ((op == '/' || op == '%') && rhs.digits.empty());
+}
+
+constexpr BigDecimal BigDecimal::specialResult(const BigDecimal& lhs, const BigDecimal& rhs, char op, unsigned* flags) {
+	auto flag = [flags](unsigned value) {
+		if (flags != nullptr) {
+			*flags |= value;
+		}
+	};
+	if (lhs.kind == Kind::nan || rhs.kind == Kind::nan) {
+		return nan();
+	}
+	bool lhsZero = lhs.kind == Kind::finite && lhs.digits.empty();
+	bool rhsZero = rhs.kind == Kind::finite && rhs.digits.empty();
+	bool rhsSign = op == '-' ? !rhs.sign : rhs.sign;
+	switch (op) {
+	case '+':
+	case '-':
+		if (lhs.kind == Kind::infinity && rhs.kind == Kind::infinity && lhs.sign != rhsSign) {
+			flag(Context::invalid);
+			return nan();
+		}
+		return infinity(!(lhs.kind == Kind::infinity ? lhs.sign : rhsSign));
+	case '*':
+		if (lhsZero || rhsZero) {
+			flag(Context::invalid);
+			return nan();
+		}
+		return infinity(lhs.sign != rhs.sign);
+	case '/':
+		if ((lhs.kind == Kind::infinity && rhs.kind == Kind::infinity) || (lhsZero && rhsZero)) {
+			flag(Context::invalid);
+			return nan();
+		}
+		if (rhs.kind == Kind::infinity) {
+			return BigDecimal{};
+		}
+		if (lhs.kind == Kind::finite) {
+			flag(Context::divisionByZero);
+		}
+		return infinity(lhs.sign != rhs.sign);
+	default:
+		if (lhs.kind == Kind::infinity || rhsZero) {
+			flag(Context::invalid);
+			return nan();
+		}
+		return lhs;
+	}
+}
+
+constexpr BigDecimal& BigDecimal::operator+=(const BigDecimal& bd) {
+	if (kind != Kind::finite || bd.kind != Kind::finite) {
+		return *this = specialResult(*this, bd, '+');
+	}
+	if (this->sign == bd.sign) {
+		doAdd(bd);
+	}
+	else {
+		doSubtract(bd);
+	}
+	return *this;
+}
+
+constexpr BigDecimal& BigDecimal::operator-=(const BigDecimal& bd) {
+	if (kind != Kind::finite || bd.kind != Kind::finite) {
+		return *this = specialResult(*this, bd, '-');
+	}
+	if (this->sign == bd.sign) {
+		doSubtract(bd);
+	}
+	else {
+		doAdd(bd);
+	}
+	return *this;
+}
+
+constexpr BigDecimal& BigDecimal::operator*=(const BigDecimal& bd) {
+	if (!std::is_constant_evaluated()) {
+		return multiplyAssign(bd);
+	}
+	if (kind != Kind::finite || bd.kind != Kind::finite) {
+		return *this = specialResult(*this, bd, '*');
+	}
+	//Plain schoolbook columns; bd may be *this, so the product is built separately
+	std::vector<int> columns(digits.size() + bd.digits.size());
+	for (size_t i = 0; i < digits.size(); i++) {
+		for (size_t j = 0; j < bd.digits.size(); j++) {
+			columns[i + j] += (digits[i] - '0') * (bd.digits[j] - '0');
+		}
+	}
+	std::vector<char> product(columns.size());
+	int carry = 0;
+	for (size_t i = 0; i < columns.size(); i++) {
+		carry += columns[i];
+		product[i] = static_cast<char>('0' + carry % 10);
+		carry /= 10;
+	}
+	digits = std::move(product);
+	sign = sign == bd.sign;
+	exponent += bd.exponent;
+	normalize();
+	return *this;
+}
+
+//Dividing in decimal is quite slow; probably the slowest operation implemented
+constexpr BigDecimal& BigDecimal::operator/=(BigDecimal bd) {
+	if (isSpecialCase(*this, bd, '/')) {
+		//Without this, the long division below would never find a multiple of zero past the remainder
+		if (kind == Kind::finite && bd.kind == Kind::finite) {
+			raise<std::domain_error>("Division by zero");
+		}
+		return *this = specialResult(*this, bd, '/');
+	}
+	BigDecimal result{};
+	BigDecimal remainder{};
+    int exponentResult = exponent - bd.exponent;
+    bool signResult = sign == bd.sign;
+    bd.exponent = 0;
+    bd.sign = true;
+	int maxDigits = static_cast<int>(std::max(digits.size(), bd.digits.size())) + 20;
+	//Long division starts with the most significant digit, so need to iterate in reverse
+	int i = static_cast<int>(digits.size()) - 1;
+	for (; i >= 0; i--) {
+		char c = digits[i];
+		remainder = remainder * 10 + (c - '0');
+		BigDecimal bdCpy = bd;
+		BigDecimal mult = 0;
+		while (bdCpy <= remainder) {
+			bdCpy += bd;
+			++mult;
+		}
+		bdCpy -= bd;
+		remainder -= bdCpy;
+		mult.exponent = i;
+		result += mult;
+	}
+	while (static_cast<int>(result.digits.size()) < maxDigits && remainder != 0) {
+		remainder *= 10;
+		BigDecimal bdCpy = bd;
+		BigDecimal mult = 0;
+		while (bdCpy <= remainder) {
+			bdCpy += bd;
+			++mult;
+		}
+		bdCpy -= bd;
+		remainder -= bdCpy;
+		mult.exponent = i;
+		result += mult;
+		i--;
+	}
+	result.exponent += exponentResult;
+	result.sign = signResult;
+	*this = result;
+	normalize();
+	return *this;
+}
+
+constexpr BigDecimal& BigDecimal::operator%=(BigDecimal bd) {
+	if (isSpecialCase(*this, bd, '%')) {
+		if (kind == Kind::finite && bd.kind == Kind::finite) {
+			raise<std::domain_error>("Division by zero");
+		}
+		return *this = specialResult(*this, bd, '%');
+	}
+    bd.sign = true;
+    bool signTemp = sign;
+    sign = true;
+    std::strong_ordering cmp = *this <=> bd;
+    if(cmp == std::strong_ordering::less) {
+        sign = signTemp;
+        return *this;
+    }
+    else if(cmp == std::strong_ordering::equal) {
+        *this = BigDecimal{};
+        return *this;
+    }
+	BigDecimal remainder{};
+	int exponentChange = 0;
+	if (exponent > 0) {
+		digits.insert(digits.begin(), exponent, '0');
+	}
+	else {
+		exponentChange = -exponent;
+		bd.exponent += exponentChange;
+	}
+	exponent = 0;
+	int i = static_cast<int>(digits.size()) - 1;
+	for (; i >= 0; i--) {
+		char c = digits[i];
+		remainder = remainder * 10 + (c - '0');
+		BigDecimal bdMult = bd;
+		while (bdMult <= remainder) {
+			bdMult += bd;
+		}
+		remainder -= bdMult - bd;
+	}
+	*this = remainder;
+	exponent -= exponentChange;
+    sign = signTemp;
+	return *this;
+}
+
+constexpr BigDecimal& BigDecimal::operator++() {
+	return *this += 1LL;
+}
+
+constexpr const BigDecimal BigDecimal::operator++(int) {
+	BigDecimal copy = *this;
+	*this += 1LL;
+	return copy;
+}
+
+constexpr BigDecimal& BigDecimal::operator--() {
+	return *this -= 1LL;
+}
+
+constexpr const BigDecimal BigDecimal::operator--(int) {
+	BigDecimal copy = *this;
+	*this -= 1LL;
+	return copy;
+}
+
+constexpr BigDecimal operator+(BigDecimal lhs, const BigDecimal& rhs) {
+	return lhs += rhs;
+}
+
+constexpr BigDecimal operator-(BigDecimal lhs, const BigDecimal& rhs) {
+	return lhs -= rhs;
+}
+
+constexpr BigDecimal operator-(BigDecimal bd) {
+	if (bd.kind == BigDecimal::Kind::nan || (bd.kind == BigDecimal::Kind::finite && bd.digits.empty())) {
+		return bd;
+	}
+	bd.sign = !bd.sign;
+	return bd;
+}
+
+constexpr BigDecimal operator*(BigDecimal lhs, const BigDecimal& rhs) {
+	return lhs *= rhs;
+}
+
+constexpr BigDecimal operator/(BigDecimal lhs, BigDecimal rhs) {
+	return lhs /= std::move(rhs);
+}
+
+constexpr BigDecimal operator%(BigDecimal lhs, BigDecimal rhs) {
+	return lhs %= std::move(rhs);
+}
+
+constexpr std::strong_ordering operator<=>(const BigDecimal& lhs, const BigDecimal& rhs) {
+	if (lhs.kind != BigDecimal::Kind::finite || rhs.kind != BigDecimal::Kind::finite) {
+		auto rank = [](const BigDecimal& bd) {
+			return bd.kind == BigDecimal::Kind::nan ? 3 : bd.kind == BigDecimal::Kind::infinity ? (bd.sign ? 2 : 0) : 1;
+		};
+		return rank(lhs) <=> rank(rhs);
+	}
+	//Zero has no most significant digit to compare by, so only the other side's sign matters
+	if (lhs.digits.empty() || rhs.digits.empty()) {
+		bool lhsPositive = !lhs.digits.empty() && lhs.sign;
+		bool rhsPositive = !rhs.digits.empty() && rhs.sign;
+		bool lhsNegative = !lhs.sign;
+		bool rhsNegative = !rhs.sign;
+		return (lhsPositive - lhsNegative) <=> (rhsPositive - rhsNegative);
+	}
+	if (lhs.sign == rhs.sign) {
+		std::strong_ordering cmp = BigDecimal::compareMagnitude(lhs, rhs);
+		if (lhs.sign)
+			return cmp;
+		else return 0 <=> cmp;
+	}
+	else return lhs.sign <=> rhs.sign;
+}
+
+constexpr std::strong_ordering BigDecimal::compareMagnitude(const BigDecimal& lhs, const BigDecimal& rhs) {
+	if (lhs.digits.empty() || rhs.digits.empty()) {
+		return !lhs.digits.empty() <=> !rhs.digits.empty();
+	}
+	int64_t lhsMaxDigit = static_cast<int64_t>(lhs.digits.size()) + lhs.exponent;
+	int64_t rhsMaxDigit = static_cast<int64_t>(rhs.digits.size()) + rhs.exponent;
+	if (lhsMaxDigit != rhsMaxDigit) {
+		return lhsMaxDigit <=> rhsMaxDigit;
+	}
+	//Digits are stored in reverse order, so compare from the back
+	return std::lexicographical_compare_three_way(lhs.digits.rbegin(), lhs.digits.rend(), rhs.digits.rbegin(), rhs.digits.rend());
+}
+
+constexpr void BigDecimal::doAdd(const BigDecimal& bd) {
+	if (exponent > bd.exponent) {
+		digits.insert(digits.begin(), exponent - bd.exponent, '0');
+		exponent = bd.exponent;
+	}
+	int align = bd.exponent - exponent;
+    if(align > static_cast<int>(digits.size())) {
+        digits.insert(digits.end(), align - digits.size(), '0');
+    }
+	bool carry = false;
+	int numDigits = std::min(static_cast<int>(digits.size()) - align,static_cast<int>(bd.digits.size()));
+	int i = 0;
+	for (; i < numDigits; i++) {
+		digits.at(i + align) += bd.digits.at(i) - '0' + static_cast<char>(carry);
+		if (digits.at(i + align) > '9') {
+			carry = true;
+			digits.at(i + align) -= 10;
+		}
+		else carry = false;
+	}
+	for (; i < static_cast<int>(bd.digits.size()); i++) {
+		digits.push_back(bd.digits.at(i) + static_cast<char>(carry));
+		if (digits.at(digits.size() - 1) > '9') {
+			carry = true;
+			digits.at(digits.size() - 1) -= 10;
+		}
+		else carry = false;
+	}
+	for (; carry != 0 && i < static_cast<int>(digits.size()) - align; i++) {
+		digits.at(i + align) += static_cast<char>(carry);
+		if (digits.at(i + align) > '9') {
+			carry = digits.at(i + align) - '9';
+			digits.at(i + align) -= 10;
+		}
+		else carry = false;
+	}
+	if (carry != 0) {
+		digits.push_back('1');
+	}
+	normalize();
+}
+
+//Subtracts bd's magnitude from this one's; called for += with opposite signs as well as -= with matching ones
+constexpr void BigDecimal::doSubtract(const BigDecimal& bd) {
+	std::strong_ordering cmp = compareMagnitude(*this, bd);
+	if (cmp == std::strong_ordering::equal) {
+		digits.clear();
+	}
+	else if (cmp == std::strong_ordering::greater) {
+		if (exponent > bd.exponent) {
+			digits.insert(digits.begin(), exponent - bd.exponent, '0');
+			exponent = bd.exponent;
+		}
+		int align = bd.exponent - exponent;
+		int numDigits = static_cast<int>(std::min(digits.size() - align, bd.digits.size()));
+		for (int i = 0; i < numDigits; i++) {
+			digits.at(i + align) -= bd.digits.at(i) - '0';
+			if (digits.at(i + align) < '0') {
+				digits.at(i + 1 + align)--; //this is allowed, since already know that this > bd
+				digits.at(i + align) += 10;
+			}
+		}
+		for (int i = numDigits + align; i < static_cast<int>(digits.size()) - 1 && digits.at(i) < '0'; i++) {
+			digits.at(i) += 10;
+			digits.at(i + 1)--;
+		}
+		if (digits.at(digits.size() - 1) < '0') { //Something went terribly wrong
+			raise<std::logic_error>("Invalid digit state");
+		}
+	}
+	else {
+		BigDecimal larger = bd; //Creates a copy, but copies are still pretty cheap
+		larger.sign = sign;
+		larger.doSubtract(*this);
+		*this = std::move(larger);
+		sign = !sign;
+	}
+	normalize();
+}
+
+template<size_t N>
+consteval BigDecimal::Literal<N>::Literal(std::array<char, N> text) {
+	//Digit separators are allowed, as in 1'000'000.25_bd
+	std::array<char, N> kept{};
+	size_t length = 0;
+	for (char c : text) {
+		if (c != '\'') {
+			kept[length++] = c;
+		}
+	}
+	BigDecimal bd{std::string_view{kept.data(), length}};
+	std::copy(bd.digits.begin(), bd.digits.end(), digits.begin());
+	size = bd.digits.size();
+	sign = bd.sign;
+	exponent = bd.exponent;
+}
+
+template<size_t N>
+BigDecimal BigDecimal::Literal<N>::value() const {
+	BigDecimal result{};
+	result.digits.assign(digits.begin(), digits.begin() + static_cast<ptrdiff_t>(size));
+	result.sign = sign;
+	result.exponent = exponent;
+	return result;
+}
+
+//A decimal literal such as 0.0001_bd or 6.02214076e23_bd, parsed and checked at compile time, so that a malformed
+//one (0x1F_bd, 1e_bd) doesn't compile. At run time it only copies the already normalized digits
+template<char... chars>
+BigDecimal operator""_bd() {
+	static constexpr BigDecimal::Literal<sizeof...(chars)> literal{std::array<char, sizeof...(chars)>{chars...}};
+	return literal.value();
+}
+
+constexpr size_t BigDecimal::FormatSpec::parse(std::string_view text) {
+	constexpr size_t malformed = std::string_view::npos;
+	auto isAlign = [](char c) { return c == '<' || c == '>' || c == '^'; };
+	auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+	size_t i = 0;
+	if (text.size() >= 2 && isAlign(text[1])) {
+		if (text[0] == '{' || text[0] == '}') {
+			return malformed;
+		}
+		fill = text[0];
+		align = text[1];
+		i = 2;
+	}
+	else if (!text.empty() && isAlign(text[0])) {
+		align = text[0];
+		i = 1;
+	}
+	if (i < text.size() && (text[i] == '+' || text[i] == '-' || text[i] == ' ')) {
+		sign = text[i++];
+	}
+	if (i < text.size() && text[i] == '0') {
+		zeroPad = true;
+		i++;
+	}
+	auto readNumber = [&](int& value) {
+		size_t start = i;
+		value = 0;
+		for (; i < text.size() && isDigit(text[i]); i++) {
+			if (value > 99999999) {
+				return false;
+			}
+			value = value * 10 + (text[i] - '0');
+		}
+		return i != start;
+	};
+	if (i < text.size() && isDigit(text[i]) && !readNumber(width)) {
+		return malformed;
+	}
+	if (i < text.size() && text[i] == '.') {
+		i++;
+		if (!readNumber(precision)) {
+			return malformed;
+		}
+	}
+	if (i < text.size() && (text[i] == 'f' || text[i] == 'e' || text[i] == 'n' || text[i] == 'g')) {
+		type = text[i++];
+	}
+	if (i < text.size() && text[i] != '}') {
+		return malformed;
+	}
+	return i;
+}
+
+template<typename Out>
+Out BigDecimal::writeLayout(Out out, const Layout& layout) const {
+	for (size_t i = 0; i < layout.count; i++) {
+		const Layout::Piece& piece = layout.pieces[i];
+		switch (piece.kind) {
+		case Layout::Piece::Kind::digits:
+			out = std::copy(digits.rbegin() + piece.first, digits.rbegin() + piece.second, out);
+			break;
+		case Layout::Piece::Kind::zeroes:
+			out = std::fill_n(out, piece.first, '0');
+			break;
+		case Layout::Piece::Kind::character:
+			*out++ = static_cast<char>(piece.first);
+			break;
+		case Layout::Piece::Kind::exponent: {
+			*out++ = 'e';
+			*out++ = piece.first < 0 ? '-' : '+';
+			char buffer[20];
+			char* end = std::to_chars(buffer, buffer + sizeof(buffer), piece.first < 0 ? -piece.first : piece.first).ptr;
+			out = std::copy(buffer, end, out);
+			break;
+		}
+		}
+	}
+	return out;
+}
+
+template<typename Out>
+Out BigDecimal::formatTo(Out out, const FormatSpec& spec) const {
+	//Everything is written straight from this value's digits, rounded or not
+	Layout layout = this->layout(spec.type, spec.precision, spec.sign);
+	size_t padding = spec.width > 0 && static_cast<size_t>(spec.width) > layout.size ? spec.width - layout.size : 0;
+	if (spec.zeroPad && spec.align == '\0' && isFinite()) {
+		//Zeroes go between the sign and the digits
+		Layout rest = layout;
+		if (rest.count > 0 && rest.pieces[0].kind == Layout::Piece::Kind::character &&
+			(rest.pieces[0].first == '-' || rest.pieces[0].first == '+' || rest.pieces[0].first == ' ')) {
+			*out++ = static_cast<char>(rest.pieces[0].first);
+			std::copy(rest.pieces.begin() + 1, rest.pieces.begin() + static_cast<ptrdiff_t>(rest.count), rest.pieces.begin());
+			rest.count--;
+		}
+		out = std::fill_n(out, padding, '0');
+		return writeLayout(out, rest);
+	}
+	size_t before = spec.align == '<' ? 0 : spec.align == '^' ? padding / 2 : padding;
+	out = std::fill_n(out, before, spec.fill);
+	out = writeLayout(out, layout);
+	return std::fill_n(out, padding - before, spec.fill);
+}
+
+struct BigDecimal::Formatter {
+	FormatSpec spec{};
+	template<typename ParseContext>
+	constexpr auto parse(ParseContext& context) {
+		size_t used = spec.parse(std::string_view{context.begin(), context.end()});
+		if (used == std::string_view::npos) {
+			rejectSpec();
+		}
+		return context.begin() + static_cast<ptrdiff_t>(used);
+	}
+	template<typename FormatContext>
+	auto format(const BigDecimal& bd, FormatContext& context) const {
+		return bd.formatTo(context.out(), spec);
+	}
+private:
+	//Throws std::format_error (std::invalid_argument without <format>). It isn't constexpr, so a bad format string
+	//checked at compile time fails to compile
+	[[noreturn]] static void rejectSpec();
+};
+
+#ifdef __cpp_lib_format
+template<>
+struct std::formatter<BigDecimal, char> : BigDecimal::Formatter {};
+#endif
@@ -2,6 +2,8 @@
 #include "doctest.h"
 #include "BigDecimal.h"
 #include <concepts>
+#include <iomanip>
+#include <thread>
 
 namespace {
     template<std::integral T>
@@ -32,6 +34,37 @@ TEST_SUITE("Constructors") {
         checkConstructorF<double>();
         checkConstructorF<float>();
     }
+    TEST_CASE("Floating point") {
+        CHECK(BigDecimal{0.1}.toString() == "0.1");
+        CHECK(BigDecimal{2.5, 0} == 2);
+        CHECK(BigDecimal{-1234.5678, 3}.toString() == "-1235");
+        CHECK(BigDecimal::exact(0.1) == BigDecimal{"0.1000000000000000055511151231257827021181583404541015625"});
+        CHECK(BigDecimal::exact(-0.375) == BigDecimal{"-0.375"});
+        CHECK(BigDecimal::exact(1e23) == BigDecimal{"99999999999999991611392"});
+        CHECK(BigDecimal::exact(-0.0) == 0);
+        CHECK(BigDecimal::exact(std::numeric_limits<double>::denorm_min()).toString().size() > 750);
+        CHECK(BigDecimal::shortest(0.1) == BigDecimal{"0.1"});
+        CHECK(BigDecimal::shortest(0.1f) == BigDecimal{"0.1"});
+        CHECK(BigDecimal::shortest(1e23) == BigDecimal{"1e23"});
+        CHECK(BigDecimal::shortest(5e-324) == BigDecimal{"5e-324"});
+        CHECK(BigDecimal::shortest(-123.456) == BigDecimal{"-123.456"});
+        CHECK(BigDecimal::shortest(0.0) == 0);
+        //float and double only generate the digits asked for; that has to agree with rounding the exact value
+        for (double d : {0.1, 2.5, 1e23, -1234.5678, 5e-324, std::numeric_limits<double>::max()}) {
+            CHECK(BigDecimal{d, 10} == BigDecimal::exact(d).round(11));
+            CHECK(BigDecimal{d, 120} == BigDecimal::exact(d).round(121));
+        }
+        CHECK(BigDecimal{0.1L, 3} == BigDecimal{"0.1"});
+        CHECK(BigDecimal::shortest(0.1L) == BigDecimal{"0.1"});
+        CHECK(BigDecimal::shortest(-0.375L) == BigDecimal{"-0.375"});
+        //Powers of two have a narrower gap below them, and the smallest normal doesn't
+        CHECK(BigDecimal::shortest(9007199254740992.0) == BigDecimal{"9007199254740992"});
+        CHECK(BigDecimal::shortest(std::numeric_limits<double>::min()) == BigDecimal{"2.2250738585072014e-308"});
+        CHECK(BigDecimal::shortest(std::numeric_limits<float>::max()) == BigDecimal{"3.4028235e38"});
+        CHECK(BigDecimal::shortest(std::numeric_limits<float>::denorm_min()) == BigDecimal{"1e-45"});
+        CHECK_THROWS_AS(BigDecimal::shortest(std::numeric_limits<double>::infinity()), std::invalid_argument);
+        CHECK_THROWS_AS(BigDecimal::exact(std::numeric_limits<double>::quiet_NaN()), std::invalid_argument);
+    }
     TEST_CASE("String") {
         CHECK(BigDecimal{"123456789.7e+50"}.toString() == "1234567897e+49");
         CHECK(BigDecimal{""} == 0);
@@ -42,6 +75,92 @@ TEST_SUITE("Constructors") {
         CHECK_THROWS_AS(BigDecimal{"1e."}, std::invalid_argument);
         CHECK_THROWS_AS(BigDecimal{"a"}, std::invalid_argument);
         CHECK_THROWS_AS(BigDecimal{"1.b"}, std::invalid_argument);
+        CHECK_THROWS_AS(BigDecimal{"1e99999999999"}, std::out_of_range);
+        CHECK(BigDecimal{std::string_view{"-0.0250"}} == BigDecimal{"-2.5e-2"});
+    }
+    TEST_CASE("Compile time") {
+        static_assert(BigDecimal{"0.1"} + BigDecimal{"0.2"} == BigDecimal{"0.3"});
+        static_assert(BigDecimal{"1.5e3"} * BigDecimal{-4} == -6000);
+        static_assert(BigDecimal{1} / 8 == BigDecimal{"0.125"});
+        static_assert(BigDecimal{"7.5"} % 2 == BigDecimal{"1.5"});
+        static_assert(BigDecimal{"-0.001"} < 0);
+        static_assert(BigDecimal::infinity() > BigDecimal{"1e100"});
+        CHECK(0.0001_bd == BigDecimal{"1e-4"});
+        CHECK(-6.02214076e23_bd == BigDecimal{"-602214076e15"});
+        CHECK(1'000'000.25_bd == BigDecimal{"1000000.25"});
+        CHECK(123456789012345678901234567890_bd == BigDecimal{"123456789012345678901234567890"});
+        CHECK(0_bd == 0);
+        CHECK(-0_bd == 0);
+        CHECK(-BigDecimal::infinity() == BigDecimal::infinity(true));
+    }
+    TEST_CASE("parse") {
+        CHECK(BigDecimal::parse("-0.0250") == BigDecimal{"-2.5e-2"});
+        CHECK(BigDecimal::parse("") == 0);
+        CHECK(*BigDecimal::parse("12.5e1") == 125);
+        CHECK(BigDecimal::parse("7").value() == 7);
+        CHECK_FALSE(BigDecimal::parse("1.0ea"));
+        CHECK(BigDecimal::parse("1.0ea").error() == BigDecimal::ParseError::invalidSyntax);
+        CHECK(BigDecimal::parse(" 1").error() == BigDecimal::ParseError::invalidSyntax);
+        CHECK(BigDecimal::parse("1e99999999999").error() == BigDecimal::ParseError::exponentOutOfRange);
+        CHECK(BigDecimal::parse("x").value_or(3) == 3);
+    }
+    TEST_CASE("Long strings") {
+        //Long digit runs are validated in blocks, so put the bad character at each offset around a block boundary
+        //Checked against the same digits accumulated arithmetically, at lengths on either side of the 16 and 32 byte blocks
+        for (size_t length : {15, 16, 17, 31, 32, 33, 47, 48, 49, 63, 64, 65, 100}) {
+            std::string text;
+            BigDecimal expected;
+            for (size_t i = 0; i < length; i++) {
+                int digit = static_cast<int>((i * 7 + 3) % 10);
+                text += static_cast<char>('0' + digit);
+                expected = expected * 10 + digit;
+            }
+            INFO("Length: ", length);
+            CHECK(BigDecimal{text} == expected);
+            //Split by a point, so both runs are scanned separately
+            std::string fraction = text.substr(0, 5) + "." + text.substr(5);
+            CHECK(BigDecimal{fraction} * pow(BigDecimal{10}, static_cast<int64_t>(length) - 5) == expected);
+        }
+        std::string digits(100, '3');
+        for (size_t i = 0; i < 70; i++) {
+            std::string bad = digits;
+            bad[i] = i % 2 == 0 ? '/' : ':';
+            INFO("Offset: ", i);
+            CHECK_THROWS_AS(BigDecimal{bad}, std::invalid_argument);
+            bad[i] = '.';
+            CHECK(BigDecimal{bad} * BigDecimal{"1e" + std::to_string(99 - i)} == BigDecimal{std::string(99, '3')});
+        }
+        std::string high = digits;
+        high[40] = static_cast<char>(0xB3);
+        CHECK_THROWS_AS(BigDecimal{high}, std::invalid_argument);
+    }
+    TEST_CASE("from_chars") {
+        BigDecimal bd{7};
+        std::string_view chars{"-12.50e3xyz"};
+        auto result = from_chars(chars.data(), chars.data() + chars.size(), bd);
+        CHECK(result.ec == std::errc{});
+        CHECK(result.ptr == chars.data() + 8);
+        CHECK(bd == -12500);
+        //An exponent marker without digits isn't consumed
+        chars = "5e+";
+        result = from_chars(chars.data(), chars.data() + chars.size(), bd);
+        CHECK(result.ptr == chars.data() + 1);
+        CHECK(bd == 5);
+        chars = "000.000";
+        result = from_chars(chars.data(), chars.data() + chars.size(), bd);
+        CHECK(result.ptr == chars.data() + chars.size());
+        CHECK(bd == 0);
+        //Failures leave the value alone
+        bd = 3;
+        chars = "-.e5";
+        result = from_chars(chars.data(), chars.data() + chars.size(), bd);
+        CHECK(result.ec == std::errc::invalid_argument);
+        CHECK(result.ptr == chars.data());
+        CHECK(bd == 3);
+        chars = "1e-9999999999";
+        result = from_chars(chars.data(), chars.data() + chars.size(), bd);
+        CHECK(result.ec == std::errc::result_out_of_range);
+        CHECK(bd == 3);
     }
 }
 
@@ -49,17 +168,233 @@ TEST_SUITE("Conversions") {
     TEST_CASE("toInt64") {
         CHECK(BigDecimal{"1.7e10"}.toInt64() == 17e9);
         CHECK_THROWS_AS(BigDecimal{"9e19"}.toInt64(), std::overflow_error);
+        CHECK_THROWS_AS(BigDecimal{"-9223372036854775809"}.toInt64(), std::underflow_error);
+        CHECK(BigDecimal{"-9223372036854775808"}.toInt64() == std::numeric_limits<int64_t>::min());
+        CHECK(BigDecimal{"0.001"}.toInt64() == 0);
+        //The digits below the point are never read past the first and whether there are any more
+        CHECK(BigDecimal{"12." + std::string(100000, '3')}.toInt64() == 12);
+        using enum BigDecimal::Rounding;
+        CHECK(BigDecimal{"-2.5"}.toInt64(towardZero) == -2);
+        CHECK(BigDecimal{"-2.5"}.toInt64(floor) == -3);
+        CHECK(BigDecimal{"-2.5"}.toInt64(ceiling) == -2);
+        CHECK(BigDecimal{"-2.5"}.toInt64(halfEven) == -2);
+        CHECK(BigDecimal{"-3.5"}.toInt64(halfEven) == -4);
+        CHECK(BigDecimal{"-2.5"}.toInt64(halfAwayFromZero) == -3);
+        CHECK(BigDecimal{"2.5000001"}.toInt64(halfEven) == 3);
+        CHECK(BigDecimal{"0.04"}.toInt64(ceiling) == 1);
+    }
+    TEST_CASE("toUint64 and toInt128") {
+        CHECK(BigDecimal{"18446744073709551615"}.toUint64() == std::numeric_limits<uint64_t>::max());
+        CHECK_FALSE(BigDecimal{"18446744073709551615.5"}.tryToUint64(BigDecimal::Rounding::ceiling));
+        CHECK(BigDecimal{"-0.5"}.toUint64() == 0);
+        CHECK_THROWS_AS(BigDecimal{-1}.toUint64(), std::underflow_error);
+        CHECK(BigDecimal{"9.5e18"}.tryToInt64() == std::nullopt);
+        CHECK(BigDecimal{"1e300"}.tryToInt64() == std::nullopt);
+        CHECK(BigDecimal{"-42.7"}.tryToInt64(BigDecimal::Rounding::halfEven) == -43);
+#ifdef __SIZEOF_INT128__
+        CHECK(BigDecimal{"-1e30"}.toInt128() == -static_cast<__int128>(1000000000000000) * 1000000000000000);
+        CHECK_FALSE(BigDecimal{"2e38"}.tryToInt128());
+#endif
     }
     TEST_CASE("toLongDouble") {
         CHECK(BigDecimal{}.toLongDouble() == 0);
         //Small integers can be precisely represented as doubles
         CHECK(BigDecimal{12345}.toLongDouble() == 12345);
+        CHECK(BigDecimal{"0.1"}.toLongDouble() == 0.1L);
+        CHECK(BigDecimal{"1e5000"}.toLongDouble() == std::numeric_limits<long double>::infinity());
+    }
+    TEST_CASE("toDouble") {
+        CHECK(BigDecimal{}.toDouble() == 0);
+        CHECK(BigDecimal{"0.1"}.toDouble() == 0.1);
+        CHECK(BigDecimal{"-123.456"}.toDouble() == -123.456);
+        CHECK(BigDecimal{"1.7976931348623157e308"}.toDouble() == std::numeric_limits<double>::max());
+        CHECK(BigDecimal{"1e309"}.toDouble() == std::numeric_limits<double>::infinity());
+        CHECK(BigDecimal{"-1e309"}.toDouble() == -std::numeric_limits<double>::infinity());
+        CHECK(BigDecimal{"5e-324"}.toDouble() == std::numeric_limits<double>::denorm_min());
+        CHECK(BigDecimal{"1e-400"}.toDouble() == 0);
+        //1 + 2^-53 is exactly halfway, so it goes to the even 1; anything past it, however far down, rounds up
+        std::string halfway = "1.00000000000000011102230246251565404236316680908203125";
+        CHECK(BigDecimal{halfway}.toDouble() == 1);
+        CHECK(BigDecimal{halfway + std::string(1000, '0') + "1"}.toDouble() == std::nextafter(1.0, 2.0));
+        CHECK(BigDecimal{"0.1"}.toFloat() == 0.1f);
+        CHECK(BigDecimal{"3.4028236e38"}.toFloat() == std::numeric_limits<float>::infinity());
+        CHECK(BigDecimal{"16777217"}.toFloat() == 16777216.0f);
     }
     TEST_CASE("toString") {
         CHECK(BigDecimal{}.toString() == "0");
         CHECK(BigDecimal{"-50001e-2"}.toString() == "-500.01");
         CHECK(BigDecimal{"100e-4"}.toString() == "1e-2");
+        CHECK(BigDecimal{"-0.00123"}.toString() == "-1.23e-3");
+        CHECK(BigDecimal{"0.123"}.toString() == "0.123");
+    }
+    TEST_CASE("to_chars") {
+        auto format = [](const BigDecimal& bd, std::chars_format fmt) {
+            char buffer[64];
+            auto result = to_chars(buffer, buffer + sizeof(buffer), bd, fmt);
+            REQUIRE(result.ec == std::errc{});
+            CHECK(static_cast<size_t>(result.ptr - buffer) == bd.formattedSize(fmt));
+            return std::string(buffer, result.ptr);
+        };
+        CHECK(format(BigDecimal{"-500.01"}, std::chars_format::general) == "-500.01");
+        CHECK(format(BigDecimal{"-500.01"}, std::chars_format::fixed) == "-500.01");
+        CHECK(format(BigDecimal{"-500.01"}, std::chars_format::scientific) == "-5.0001e+2");
+        CHECK(format(BigDecimal{"5e+3"}, std::chars_format::fixed) == "5000");
+        CHECK(format(BigDecimal{"5e+3"}, std::chars_format::scientific) == "5e+3");
+        CHECK(format(BigDecimal{"0.00123"}, std::chars_format::fixed) == "0.00123");
+        CHECK(format(BigDecimal{"0.00123"}, std::chars_format::scientific) == "1.23e-3");
+        CHECK(format(BigDecimal{}, std::chars_format::fixed) == "0");
+        CHECK(format(BigDecimal{}, std::chars_format::scientific) == "0e+0");
+
+        char small[4];
+        BigDecimal bd{"-500.01"};
+        CHECK(to_chars(small, small + sizeof(small), bd).ec == std::errc::value_too_large);
+        CHECK(to_chars(small, small + sizeof(small), bd, std::chars_format::hex).ec == std::errc::invalid_argument);
+    }
+    TEST_CASE("serialize") {
+        auto roundTrip = [](const BigDecimal& bd) {
+            std::vector<std::byte> buffer(bd.serializedSize());
+            REQUIRE(bd.serialize(buffer) == buffer.size());
+            BigDecimal result{42};
+            CHECK(BigDecimal::deserialize(buffer, result) == buffer.size());
+            return result;
+        };
+        for (const char* text : {"0", "1", "-1", "999", "1000", "-123.456e-7", "1e2147483647", "-1e-2147483648", "31415926535897932384626433832795"}) {
+            INFO("Value: ", text);
+            CHECK(roundTrip(BigDecimal{text}) == BigDecimal{text});
+        }
+        CHECK(roundTrip(BigDecimal::infinity(true)) == BigDecimal::infinity(true));
+        CHECK(roundTrip(BigDecimal::nan()).isNaN());
+        CHECK(BigDecimal{}.serializedSize() == 2);
+        CHECK(BigDecimal{"123456"}.serializedSize() == 5);
+        CHECK(BigDecimal::infinity().serializedSize() == 1);
+
+        //Values can be read back one after another
+        std::vector<std::byte> buffer(64);
+        size_t used = BigDecimal{"-2.5"}.serialize(buffer);
+        used += BigDecimal{"7e100"}.serialize(std::span{buffer}.subspan(used));
+        BigDecimal first, second;
+        size_t read = BigDecimal::deserialize(buffer, first);
+        read += BigDecimal::deserialize(std::span{buffer}.subspan(read), second);
+        CHECK(read == used);
+        CHECK(first == BigDecimal{"-2.5"});
+        CHECK(second == BigDecimal{"7e100"});
+
+        std::array<std::byte, 2> small{};
+        CHECK(BigDecimal{"123456"}.serialize(small) == 0);
+        //Truncated, a digit group over 999, trailing zero digits, and a negative zero
+        auto bytes = [](std::initializer_list<int> values) {
+            std::vector<std::byte> result;
+            for (int v : values) {
+                result.push_back(static_cast<std::byte>(v));
+            }
+            return result;
+        };
+        BigDecimal untouched{5};
+        CHECK(BigDecimal::deserialize(bytes({0x00, 0x03, 0x7B}), untouched) == 0);
+        CHECK(BigDecimal::deserialize(bytes({0x00, 0x03, 0xE8, 0x03}), untouched) == 0);
+        CHECK(BigDecimal::deserialize(bytes({0x00, 0x02, 0x0A, 0x00}), untouched) == 0);
+        CHECK(BigDecimal::deserialize(bytes({0x01, 0x00}), untouched) == 0);
+        CHECK(BigDecimal::deserialize(bytes({0x80, 0x00, 0x00}), untouched) == 0);
+        CHECK(untouched == 5);
+        CHECK(BigDecimal::deserialize(bytes({0x00, 0x03, 0x7B, 0x00}), untouched) == 4);
+        CHECK(untouched == 123);
+    }
+    TEST_CASE("encodeKey") {
+        auto key = [](const BigDecimal& bd) {
+            std::vector<std::byte> result(bd.keySize());
+            REQUIRE(bd.encodeKey(result) == result.size());
+            return result;
+        };
+        //Listed in increasing order, so the keys should be too
+        std::vector<BigDecimal> values{BigDecimal::infinity(true), BigDecimal{"-1e1000"}, BigDecimal{"-123.5"}, BigDecimal{"-123"},
+            BigDecimal{"-2"}, BigDecimal{"-0.001"}, BigDecimal{}, BigDecimal{"1e-1000"}, BigDecimal{"0.5"}, BigDecimal{"1"},
+            BigDecimal{"1.01"}, BigDecimal{"1.1"}, BigDecimal{"9.99"}, BigDecimal{"10"}, BigDecimal{"123"}, BigDecimal{"123.1"},
+            BigDecimal{"1e2147483647"}, BigDecimal::infinity(), BigDecimal::nan()};
+        std::vector<std::byte> previous;
+        for (const BigDecimal& value : values) {
+            INFO("Value: ", value);
+            std::vector<std::byte> encoded = key(value);
+            BigDecimal decoded{42};
+            CHECK(BigDecimal::decodeKey(encoded, decoded) == encoded.size());
+            CHECK(decoded == value);
+            CHECK(previous < encoded);
+            previous = encoded;
+        }
+        CHECK(key(BigDecimal{"1.50"}) == key(BigDecimal{"15e-1"}));
+        std::array<std::byte, 2> small{};
+        CHECK(BigDecimal{"123"}.encodeKey(small) == 0);
+        BigDecimal untouched{5};
+        std::vector<std::byte> truncated = key(BigDecimal{"-123.5"});
+        truncated.pop_back();
+        CHECK(BigDecimal::decodeKey(truncated, untouched) == 0);
+        CHECK(BigDecimal::decodeKey(std::vector<std::byte>{std::byte{0}}, untouched) == 0);
+        CHECK(untouched == 5);
     }
+    TEST_CASE("formatTo") {
+        auto format = [](const BigDecimal& bd, std::string_view text) {
+            BigDecimal::FormatSpec spec;
+            REQUIRE(spec.parse(text) == text.size());
+            std::string result;
+            bd.formatTo(std::back_inserter(result), spec);
+            return result;
+        };
+        CHECK(format(BigDecimal{"-500.01"}, "") == "-500.01");
+        CHECK(format(BigDecimal{"-500.01"}, ".2g") == "-5e+2");
+        CHECK(format(BigDecimal{"2.675"}, ".2f") == "2.68");
+        CHECK(format(BigDecimal{"2.665"}, ".2f") == "2.66");
+        CHECK(format(BigDecimal{"0.004"}, ".2f") == "0.00");
+        CHECK(format(BigDecimal{"0.006"}, ".2f") == "0.01");
+        CHECK(format(BigDecimal{"12.5"}, ".3f") == "12.500");
+        CHECK(format(BigDecimal{"5e+3"}, "f") == "5000");
+        CHECK(format(BigDecimal{"12345"}, ".2e") == "1.23e+4");
+        CHECK(format(BigDecimal{"9.99"}, ".1e") == "1.0e+1");
+        CHECK(format(BigDecimal{"12345"}, "n") == "12.345e+3");
+        CHECK(format(BigDecimal{"0.0000123"}, ".3n") == "12.30e-6");
+        CHECK(format(BigDecimal{}, ".2e") == "0.00e+0");
+        CHECK(format(BigDecimal{"1.5"}, "+") == "+1.5");
+        CHECK(format(BigDecimal{"1.5"}, " ") == " 1.5");
+        CHECK(format(BigDecimal{"1.5"}, "8") == "     1.5");
+        CHECK(format(BigDecimal{"1.5"}, "*<8") == "1.5*****");
+        CHECK(format(BigDecimal{"1.5"}, "*^8") == "**1.5***");
+        CHECK(format(BigDecimal{"-1.5"}, "08.2f") == "-0001.50");
+
+        BigDecimal::FormatSpec spec;
+        CHECK(spec.parse("10.3f}") == 5);
+        CHECK(spec.parse(".f") == std::string_view::npos);
+        CHECK(spec.parse("x") == std::string_view::npos);
+    }
+    TEST_CASE("Formatter") {
+        //std::formatter<BigDecimal> is this class; the contexts here stand in for std::format's
+        struct ParseContext {
+            std::string_view text;
+            const char* begin() const { return text.data(); }
+            const char* end() const { return text.data() + text.size(); }
+        };
+        struct FormatContext {
+            std::string& result;
+            auto out() { return std::back_inserter(result); }
+        };
+        auto format = [](std::string_view text, const BigDecimal& bd) {
+            BigDecimal::Formatter formatter;
+            ParseContext parseContext{text};
+            CHECK(*formatter.parse(parseContext) == '}');
+            std::string result;
+            FormatContext formatContext{result};
+            formatter.format(bd, formatContext);
+            return result;
+        };
+        CHECK(format(">10.2f}", BigDecimal{"3.14159"}) == "      3.14");
+        CHECK(format("}", BigDecimal{"-5e+2"}) == "-5e+2");
+        CHECK(format("+.3n}", BigDecimal{"0.0000123"}) == "+12.30e-6");
+        BigDecimal::Formatter formatter;
+        ParseContext bad{"10.x}"};
+        CHECK_THROWS(formatter.parse(bad));
+    }
+#ifdef __cpp_lib_format
+    TEST_CASE("std::format") {
+        CHECK(std::format("{:>10.2f}|{}", BigDecimal{"3.14159"}, BigDecimal{"-5e+2"}) == "      3.14|-5e+2");
+    }
+#endif
 }
 
 TEST_SUITE("Operators") {
@@ -73,6 +408,11 @@ TEST_SUITE("Operators") {
         bd = BigDecimal{"233465.76894e-50"};
         bd += BigDecimal{"-233465.76894e-50"};
         CHECK(bd == 0);
+        bd = -1;
+        bd += 5;
+        CHECK(bd == 4);
+        bd += BigDecimal{"-4.5"};
+        CHECK(bd == BigDecimal{"-0.5"});
     }
     TEST_CASE("-=") {
         BigDecimal bd{1234};
@@ -91,6 +431,360 @@ TEST_SUITE("Operators") {
         bd *= BigDecimal{"0.2"};
         CHECK(bd == BigDecimal{"5e100"});
     }
+    TEST_CASE("square") {
+        CHECK(BigDecimal{}.square() == 0);
+        CHECK(BigDecimal{"-1.5"}.square() == BigDecimal{"2.25"});
+        //Long enough to go through the Karatsuba path
+        BigDecimal bd{std::string(150, '9') + "." + std::string(90, '7')};
+        CHECK(bd.square() == bd * BigDecimal{bd});
+        BigDecimal copy = bd;
+        bd *= bd;
+        CHECK(bd == copy.square());
+    }
+    TEST_CASE("round") {
+        CHECK(BigDecimal{"123.456"}.round(4) == BigDecimal{"123.5"});
+        CHECK(BigDecimal{"-2.5"}.round(1) == -2);
+        CHECK(BigDecimal{"3.5"}.round(1) == 4);
+        CHECK(BigDecimal{"9.96"}.round(2) == 10);
+        const BigDecimal kept{"2.50000000001"};
+        CHECK(kept.rounded(1) == 3);
+        CHECK(BigDecimal{"-2.5"}.rounded(1) == -2);
+        CHECK(kept == BigDecimal{"2.50000000001"});
+        CHECK_THROWS_AS(BigDecimal{1}.round(0), std::invalid_argument);
+    }
+    TEST_CASE("multiply with precision") {
+        BigDecimal a{std::string(120, '3') + ".14159"};
+        BigDecimal b{"-2." + std::string(130, '7')};
+        for (int precision : {1, 10, 50, 100, 200, 400}) {
+            INFO("Precision: ", precision);
+            CHECK(multiply(a, b, precision) == (a * b).round(precision));
+        }
+        //Exact halfway products need the full product to break the tie
+        BigDecimal half{"1" + std::string(80, '0') + "5"};
+        CHECK(multiply(half, 1, 81) == (half * 1).round(81));
+        CHECK(multiply(0, a, 5) == 0);
+    }
+    TEST_CASE("divide with precision") {
+        CHECK(divide(1, 3, 5) == BigDecimal{"0.33333"});
+        CHECK(divide(2, 3, 5) == BigDecimal{"0.66667"});
+        CHECK(divide(-1, 8, 2) == BigDecimal{"-0.12"});
+        CHECK(divide(BigDecimal{"1e50"}, 7, 30) == BigDecimal{"142857142857142857142857142857e+20"});
+        BigDecimal big{std::string(60, '9')};
+        CHECK(divide(big, big + 1, 40) == 1);
+        CHECK(divide(0, 3, 5) == 0);
+        CHECK_THROWS_AS(divide(1, 0, 5), std::domain_error);
+    }
+    TEST_CASE("tryDivide") {
+        CHECK(tryDivide(BigDecimal{1}, BigDecimal{3}, 5) == BigDecimal{"0.33333"});
+        CHECK(tryDivide(BigDecimal{}, BigDecimal{3}, 5) == 0);
+        CHECK(tryDivide(BigDecimal{1}, BigDecimal{}, 5) == std::nullopt);
+        CHECK(tryDivide(BigDecimal{1}, BigDecimal{3}, 0) == std::nullopt);
+        CHECK(tryDivide(BigDecimal{"1e2000000000"}, BigDecimal{"1e-2000000000"}, 5) == std::nullopt);
+    }
+    TEST_CASE("special values") {
+        BigDecimal inf = BigDecimal::infinity();
+        BigDecimal nan = BigDecimal::nan();
+        CHECK(inf.isInfinite());
+        CHECK(!inf.isFinite());
+        CHECK(nan.isNaN());
+        CHECK(BigDecimal{3}.isFinite());
+        CHECK(inf + 1 == inf);
+        CHECK(1 - inf == BigDecimal::infinity(true));
+        CHECK((inf - inf).isNaN());
+        CHECK(-2 * inf == BigDecimal::infinity(true));
+        CHECK((inf * 0).isNaN());
+        CHECK(5 / inf == 0);
+        CHECK((inf / inf).isNaN());
+        CHECK(5 % inf == 5);
+        CHECK((inf % 5).isNaN());
+        CHECK((nan + 1).isNaN());
+        CHECK(tryDivide(1, inf, 5) == 0);
+        //Everything is ordered: -inf < finite < inf < NaN
+        CHECK(BigDecimal::infinity(true) < BigDecimal{"-1e100"});
+        CHECK(BigDecimal{"1e100"} < inf);
+        CHECK(inf < nan);
+        CHECK(nan == BigDecimal::nan());
+        CHECK(BigDecimal::infinity(true).toString() == "-inf");
+        CHECK(nan.toString() == "nan");
+        //Every reader takes the special values back, signed and in any case
+        for (const BigDecimal& special : {inf, BigDecimal::infinity(true), nan}) {
+            CHECK(BigDecimal{special.toString()} == special);
+            CHECK(BigDecimal::parse(special.toString()) == special);
+            std::stringstream ss;
+            ss << special << " " << special;
+            BigDecimal read;
+            ss >> read;
+            CHECK(read == special);
+            std::string text = special.toString();
+            CHECK(from_chars(text.data(), text.data() + text.size(), read).ptr == text.data() + text.size());
+            CHECK(read == special);
+        }
+        CHECK(BigDecimal{"+Infinity"} == inf);
+        CHECK(BigDecimal{"-INF"} == BigDecimal::infinity(true));
+        CHECK(BigDecimal{"NaN"}.isNaN());
+        CHECK_THROWS_AS(BigDecimal{"infinit"}, std::invalid_argument);
+        CHECK_THROWS_AS(BigDecimal{"in"}, std::invalid_argument);
+        CHECK_THROWS_AS(BigDecimal{"inf5"}, std::invalid_argument);
+        //Like std::from_chars, the longest special value at the front is taken
+        std::string partial = "infinite";
+        BigDecimal value;
+        CHECK(from_chars(partial.data(), partial.data() + partial.size(), value).ptr == partial.data() + 3);
+        CHECK(value == inf);
+        CHECK(inf.toDouble() == std::numeric_limits<double>::infinity());
+        CHECK(std::isnan(nan.toDouble()));
+        CHECK(inf.tryToInt64() == std::nullopt);
+        CHECK_THROWS_AS(sqrt(inf, 5), std::domain_error);
+        CHECK_THROWS_AS(gcd(nan, 5), std::domain_error);
+    }
+    TEST_CASE("Context") {
+        BigDecimal::Context context{5};
+        CHECK(context.add(1, BigDecimal{"0.5"}) == BigDecimal{"1.5"});
+        CHECK(context.flags() == 0);
+        CHECK(context.divide(BigDecimal{"7.5"}, BigDecimal{"-2.5e-3"}) == -3000);
+        CHECK(context.divide(1, 64) == BigDecimal{"0.015625"});
+        CHECK(context.flags() == 0);
+        CHECK(context.divide(1, 256) == BigDecimal{"0.0039062"});
+        CHECK(context.flags() == BigDecimal::Context::inexact);
+        context.clearFlags();
+        CHECK(context.divide(1, 3) == BigDecimal{"0.33333"});
+        CHECK(context.test(BigDecimal::Context::inexact));
+        CHECK(context.divide(-1, 0) == BigDecimal::infinity(true));
+        CHECK(context.test(BigDecimal::Context::divisionByZero));
+        CHECK(!context.test(BigDecimal::Context::invalid));
+        CHECK(context.divide(0, 0).isNaN());
+        CHECK(context.test(BigDecimal::Context::invalid));
+        context.clearFlags();
+        //The far smaller operand only decides the rounding
+        CHECK(context.add(BigDecimal{"12345"}, BigDecimal{"0.5e-1000000"}) == 12345);
+        CHECK(context.subtract(BigDecimal{"12345"}, BigDecimal{"0.5e-1000000"}) == 12345);
+        CHECK(context.add(BigDecimal{"12344.5"}, BigDecimal{"1e-1000000"}) == 12345);
+        CHECK(context.subtract(BigDecimal{"12345.5"}, BigDecimal{"1e-1000000"}) == 12345);
+        CHECK(context.flags() == BigDecimal::Context::inexact);
+        context.clearFlags();
+        CHECK(context.multiply(BigDecimal{"1.5"}, 4) == 6);
+        CHECK(context.flags() == 0);
+        CHECK(context.multiply(BigDecimal{"25e10"}, BigDecimal{"4096"}) == BigDecimal{"1024e12"});
+        CHECK(context.flags() == 0);
+        CHECK(context.multiply(BigDecimal{"123456789"}, BigDecimal{"987654321"}) == BigDecimal{"12193e13"});
+        CHECK(context.flags() == BigDecimal::Context::inexact);
+        context.clearFlags();
+        CHECK(context.multiply(BigDecimal{"1e2000000000"}, BigDecimal{"1e2000000000"}) == BigDecimal::infinity());
+        CHECK(context.test(BigDecimal::Context::overflow));
+        context.clearFlags();
+        CHECK(context.multiply(BigDecimal{"1e-2000000000"}, BigDecimal{"1e-2000000000"}) == 0);
+        CHECK(context.flags() == BigDecimal::Context::inexact);
+        context.clearFlags();
+        CHECK(context.toInt64(BigDecimal{"1e30"}) == std::numeric_limits<int64_t>::max());
+        CHECK(context.toInt64(BigDecimal::infinity(true)) == std::numeric_limits<int64_t>::min());
+        CHECK(context.toInt64(BigDecimal::nan()) == 0);
+        CHECK(context.flags() == BigDecimal::Context::invalid);
+        CHECK(context.toInt64(BigDecimal{"2.5"}, BigDecimal::Rounding::halfEven) == 2);
+        CHECK(context.test(BigDecimal::Context::inexact));
+        CHECK_THROWS_AS(BigDecimal::Context{0}, std::invalid_argument);
+    }
+    TEST_CASE("pow") {
+        CHECK(pow(BigDecimal{2}, 0) == 1);
+        CHECK(pow(BigDecimal{2}, 100) == BigDecimal{"1267650600228229401496703205376"});
+        CHECK(pow(BigDecimal{"-1.5"}, 3) == BigDecimal{"-3.375"});
+        CHECK(pow(BigDecimal{"1e5"}, 7) == BigDecimal{"1e35"});
+        CHECK(pow(BigDecimal{"-0.01"}, -3) == BigDecimal{"-1e6"});
+        CHECK(pow(BigDecimal{2}, -2) == BigDecimal{"0.25"});
+        CHECK(pow(BigDecimal{3}, 1000, 10) == BigDecimal{"1.322070819e477"});
+        CHECK(pow(BigDecimal{3}, -1, 4) == BigDecimal{"0.3333"});
+        //Single digit bases take the in-place path; check it against plain repeated multiplication
+        BigDecimal sevens = 1;
+        for (int i = 0; i < 75; i++) {
+            sevens *= BigDecimal{"-7e-3"};
+        }
+        CHECK(pow(BigDecimal{"-7e-3"}, 75) == sevens);
+        CHECK(pow(BigDecimal{"-7e-3"}, 75, 20) == BigDecimal{sevens}.round(20));
+        CHECK(pow(BigDecimal{"5e2"}, -3) == BigDecimal{"8e-9"});
+        CHECK(pow(BigDecimal{"3e2"}, -2, 5) == BigDecimal{"1.1111e-5"});
+        CHECK_THROWS_AS(pow(BigDecimal{0}, -1), std::domain_error);
+        CHECK_THROWS_AS(pow(BigDecimal{"1e1000"}, 1000000000), std::overflow_error);
+        CHECK_THROWS_AS(pow(BigDecimal{10}, std::numeric_limits<int64_t>::max()), std::overflow_error);
+        CHECK_THROWS_AS(pow(BigDecimal{"0.1"}, std::numeric_limits<int64_t>::min()), std::overflow_error);
+        CHECK(pow(BigDecimal{"0.1"}, int64_t{1} << 31) == BigDecimal{"1e-2147483648"});
+        CHECK(pow(BigDecimal{1}, std::numeric_limits<int64_t>::min()) == 1);
+    }
+    TEST_CASE("sqrt") {
+        CHECK(sqrt(BigDecimal{2}, 20) == BigDecimal{"1.4142135623730950488"});
+        CHECK(sqrt(BigDecimal{"0.0144"}, 10) == BigDecimal{"0.12"});
+        CHECK(sqrt(BigDecimal{"1e-101"}, 5) == BigDecimal{"3.1623e-51"});
+        CHECK(sqrt(0, 5) == 0);
+        BigDecimal big = sqrt(BigDecimal{"2e1000"}, 1000);
+        CHECK(big.square().round(999) == BigDecimal{"2e1000"});
+        CHECK_THROWS_AS(sqrt(-1, 5), std::domain_error);
+    }
+    TEST_CASE("root") {
+        CHECK(root(27, 3, 10) == 3);
+        CHECK(root(-32, 5, 10) == -2);
+        CHECK(root(2, 3, 15) == BigDecimal{"1.25992104989487"});
+        CHECK(root(BigDecimal{"1e-300"}, 7, 8) == BigDecimal{"1.3894955e-43"});
+        CHECK(root(BigDecimal{"12.5"}, 1, 2) == 12);
+        CHECK_THROWS_AS(root(-16, 4, 5), std::domain_error);
+        CHECK_THROWS_AS(root(16, 0, 5), std::invalid_argument);
+    }
+    TEST_CASE("exp") {
+        CHECK(exp(1, 30) == BigDecimal{"2.71828182845904523536028747135"});
+        CHECK(exp(BigDecimal{"-2.5"}, 20) == BigDecimal{"0.082084998623898795170"});
+        CHECK(exp(100, 25) == BigDecimal{"2.688117141816135448412626e43"});
+        CHECK(exp(0, 5) == 1);
+        CHECK_THROWS_AS(exp(1, 0), std::invalid_argument);
+        CHECK_THROWS_AS(exp(BigDecimal{"129038875e9"}, 8), std::overflow_error);
+        CHECK_THROWS_AS(exp(BigDecimal{"-129038875e9"}, 8), std::underflow_error);
+        CHECK_THROWS_AS(exp(BigDecimal{"-1e5000"}, 8), std::underflow_error);
+    }
+    TEST_CASE("log") {
+        CHECK(log(2, 30) == BigDecimal{"0.693147180559945309417232121458"});
+        CHECK(log(BigDecimal{"1e-50"}, 20) == BigDecimal{"-115.12925464970228420"});
+        CHECK(log(BigDecimal{"1.000001"}, 15) == BigDecimal{"9.99999500000333e-7"});
+        CHECK(log(BigDecimal{"7.3e1000"}, 25) == BigDecimal{"2304.572967342200029463066"});
+        CHECK(log(1, 5) == 0);
+        CHECK_THROWS_AS(log(0, 5), std::domain_error);
+        CHECK_THROWS_AS(log(-2, 5), std::domain_error);
+    }
+    TEST_CASE("log10") {
+        CHECK(log10(2, 20) == BigDecimal{"0.30102999566398119521"});
+        CHECK(log10(BigDecimal{"1e-30"}, 5) == -30);
+        CHECK_THROWS_AS(log10(0, 5), std::domain_error);
+    }
+    TEST_CASE("sin") {
+        CHECK(sin(1, 30) == BigDecimal{"0.841470984807896506652502321630"});
+        CHECK(sin(BigDecimal{"1e20"}, 20) == BigDecimal{"-0.64525128526578084421"});
+        //355 is very close to 113 pi, so most of the digits of the reduced argument cancel
+        CHECK(sin(355, 15) == BigDecimal{"-0.0000301443533594884"});
+        CHECK(sin(0, 5) == 0);
+        CHECK_THROWS_AS(sin(1, 0), std::invalid_argument);
+    }
+    TEST_CASE("cos") {
+        CHECK(cos(1, 30) == BigDecimal{"0.540302305868139717400936607443"});
+        CHECK(cos(BigDecimal{"1e-30"}, 20) == 1);
+        CHECK(cos(0, 5) == 1);
+    }
+    TEST_CASE("tan") {
+        CHECK(tan(BigDecimal{"1.5"}, 25) == BigDecimal{"14.10141994717171938764608"});
+        CHECK(tan(BigDecimal{"-1.5"}, 25) == BigDecimal{"-14.10141994717171938764608"});
+        CHECK(tan(0, 5) == 0);
+    }
+    TEST_CASE("atan") {
+        CHECK(atan(1, 30) == BigDecimal{"0.785398163397448309615660845820"});
+        CHECK(atan(BigDecimal{"0.5"}, 20) == BigDecimal{"0.46364760900080611621"});
+        CHECK(atan(BigDecimal{"-1e6"}, 25) == BigDecimal{"-1.570795326794896619564655"});
+        CHECK(atan(0, 5) == 0);
+    }
+    TEST_CASE("factorial") {
+        CHECK(factorial(0) == 1);
+        CHECK(factorial(20) == 2432902008176640000);
+        BigDecimal product = 1;
+        for (int i = 2; i <= 300; i++) {
+            product *= i;
+        }
+        CHECK(factorial(300) == product);
+        CHECK_THROWS_AS(factorial(-1), std::invalid_argument);
+    }
+    TEST_CASE("binomial") {
+        CHECK(binomial(100, 37) == BigDecimal{"3420029547493938143902737600"});
+        CHECK(binomial(200, 100) == BigDecimal{"90548514656103281165404177077484163874504589675413336841320"});
+        CHECK(binomial(1000000000, 3) == BigDecimal{"166666666166666667000000000"});
+        CHECK(binomial(-5, 3) == -35);
+        CHECK(binomial(5, 6) == 0);
+        CHECK(binomial(5, -1) == 0);
+    }
+    TEST_CASE("rising and falling factorials") {
+        CHECK(risingFactorial(BigDecimal{"0.5"}, 4) == BigDecimal{"6.5625"});
+        CHECK(risingFactorial(1, 10) == factorial(10));
+        CHECK(fallingFactorial(10, 3) == 720);
+        CHECK(fallingFactorial(7, 0) == 1);
+        CHECK_THROWS_AS(risingFactorial(1, -1), std::invalid_argument);
+    }
+    TEST_CASE("gcd") {
+        CHECK(gcd(12, 18) == 6);
+        CHECK(gcd(-12, 18) == 6);
+        CHECK(gcd(0, -7) == 7);
+        CHECK(gcd(0, 0) == 0);
+        CHECK(gcd(BigDecimal{"1e30"}, BigDecimal{"6e20"}) == BigDecimal{"2e20"});
+        //Long enough for the Lehmer steps
+        BigDecimal a = pow(BigDecimal{2}, 200) * pow(BigDecimal{3}, 50) * 7;
+        BigDecimal b = pow(BigDecimal{6}, 120) * 11;
+        CHECK(gcd(a, b) == pow(BigDecimal{2}, 120) * pow(BigDecimal{3}, 50));
+        CHECK_THROWS_AS(gcd(BigDecimal{"1.5"}, 3), std::invalid_argument);
+    }
+    TEST_CASE("lcm") {
+        CHECK(lcm(4, 6) == 12);
+        CHECK(lcm(-4, 6) == 12);
+        CHECK(lcm(0, 6) == 0);
+        CHECK(lcm(BigDecimal{"1e20"}, 3) == BigDecimal{"3e20"});
+    }
+    TEST_CASE("isDivisibleBy") {
+        CHECK(BigDecimal{"123456789123456789"}.isDivisibleBy(9));
+        CHECK_FALSE(BigDecimal{"123456789123456788"}.isDivisibleBy(9));
+        CHECK(BigDecimal{"7.5"}.isDivisibleBy(BigDecimal{"2.5"}));
+        CHECK(BigDecimal{0}.isDivisibleBy(5));
+        CHECK_THROWS_AS(BigDecimal{5}.isDivisibleBy(0), std::domain_error);
+    }
+    TEST_CASE("evaluatePolynomial") {
+        //3 - 2x + x^3
+        std::vector<BigDecimal> coefficients{3, -2, 0, 1};
+        CHECK(evaluatePolynomial(coefficients, 2) == 7);
+        CHECK(evaluatePolynomial(coefficients, BigDecimal{"-1.5"}) == BigDecimal{"2.625"});
+        CHECK(evaluatePolynomial(coefficients, 0) == 3);
+        CHECK(evaluatePolynomial(std::vector<BigDecimal>{}, 5) == 0);
+        //1 + x + ... + x^20 at 1/3, rounded
+        std::vector<BigDecimal> ones(21, BigDecimal{1});
+        CHECK(evaluatePolynomial(ones, divide(1, 3, 40), 15) == BigDecimal{"1.49999999985660"});
+        std::vector<BigDecimal> xs{1, -1, BigDecimal{"0.1"}};
+        std::vector<BigDecimal> expected{2, 4, BigDecimal{"2.801"}};
+        CHECK(evaluatePolynomial(coefficients, xs) == expected);
+        CHECK_THROWS_AS(evaluatePolynomial(coefficients, 2, -1), std::invalid_argument);
+    }
+    TEST_CASE("constants") {
+        CHECK(BigDecimal::pi(40) == BigDecimal{"3.141592653589793238462643383279502884197"});
+        CHECK(BigDecimal::e(35) == BigDecimal{"2.7182818284590452353602874713526625"});
+        CHECK(BigDecimal::ln2(25) == BigDecimal{"0.6931471805599453094172321"});
+        CHECK(BigDecimal::ln10(30) == BigDecimal{"2.30258509299404568401799145468"});
+        //Lower precisions are rounded from the cached value
+        CHECK(BigDecimal::pi(3) == BigDecimal{"3.14"});
+        CHECK(BigDecimal::ln2(1) == BigDecimal{"0.7"});
+        CHECK(BigDecimal::pi(500).round(40) == BigDecimal::pi(40));
+        CHECK_THROWS_AS(BigDecimal::pi(0), std::invalid_argument);
+    }
+    TEST_CASE("constants across threads") {
+        //Each thread asks for the precisions in a different order, so the cache gets read while other threads are
+        //extending it. Correctly rounded values are unique, so they have to match the ones asked for afterwards
+        const std::vector<int> precisions{60, 700, 150, 1500, 35, 1000, 2200, 90};
+        constexpr size_t threadCount = 8;
+        std::vector<std::vector<std::pair<BigDecimal, BigDecimal>>> results(threadCount);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < threadCount; t++) {
+            threads.emplace_back([&, t] {
+                for (size_t i = 0; i < precisions.size(); i++) {
+                    int precision = precisions[(i + t) % precisions.size()];
+                    results[t].emplace_back(BigDecimal::pi(precision), BigDecimal::ln2(precision));
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        for (size_t t = 0; t < threadCount; t++) {
+            for (size_t i = 0; i < precisions.size(); i++) {
+                int precision = precisions[(i + t) % precisions.size()];
+                INFO("Thread: ", t, ", precision: ", precision);
+                CHECK(results[t][i].first == BigDecimal::pi(precision));
+                CHECK(results[t][i].second == BigDecimal::ln2(precision));
+            }
+        }
+        CHECK(BigDecimal::pi(2200).round(40) == BigDecimal{"3.141592653589793238462643383279502884197"});
+        CHECK(BigDecimal::ln2(2200).round(25) == BigDecimal{"0.6931471805599453094172321"});
+    }
+    TEST_CASE("pow real") {
+        CHECK(pow(2, BigDecimal{"1.5"}, 20) == BigDecimal{"2.8284271247461900976"});
+        CHECK(pow(BigDecimal{"1e-7"}, BigDecimal{"0.5"}, 10) == BigDecimal{"0.0003162277660"});
+        CHECK(pow(3, BigDecimal{4}, 10) == 81);
+        CHECK(pow(0, BigDecimal{"0.5"}, 10) == 0);
+        CHECK_THROWS_AS(pow(-2, BigDecimal{"0.5"}, 10), std::domain_error);
+    }
     TEST_CASE("/=") {
         BigDecimal bd{1000};
         bd /= BigDecimal{"0.2"};
@@ -101,6 +795,39 @@ TEST_SUITE("Operators") {
         CHECK(bd == 500000);
         bd /= BigDecimal{"1e7"};
         CHECK(bd == BigDecimal{".05"});
+        bd = -10;
+        bd /= 4;
+        CHECK(bd == BigDecimal{"-2.5"});
+    }
+    TEST_CASE("Divisor") {
+        BigDecimal::Divisor days{365};
+        BigDecimal bd{"123456789.25"};
+        CHECK(bd / days == bd / 365);
+        CHECK(bd % days == bd % 365);
+        CHECK(BigDecimal{-730} / days == -2);
+        CHECK(BigDecimal{"-13"} % BigDecimal::Divisor{3} == -1);
+        CHECK(BigDecimal{"0.4"} % BigDecimal::Divisor{BigDecimal{"2e50"}} == BigDecimal{"0.4"});
+        //Too long for the machine word path, so this goes through the reciprocal
+        BigDecimal big{std::string(40, '7') + ".3"};
+        BigDecimal::Divisor divisor{big};
+        BigDecimal dividend{std::string(90, '4') + "e-7"};
+        CHECK(dividend / divisor == dividend / big);
+        CHECK(dividend % divisor == dividend % big);
+        CHECK(divisor.value() == big);
+        CHECK_THROWS_AS(BigDecimal::Divisor{0}, std::invalid_argument);
+    }
+    TEST_CASE("Modulus") {
+        BigDecimal::Modulus prime{1000000007};
+        CHECK(prime.powmod(2, 100) == 976371285);
+        CHECK(prime.reduce(-1) == 1000000006);
+        CHECK(prime.mulmod(BigDecimal{"1e12"}, BigDecimal{"1e12"}) == prime.reduce(BigDecimal{"1e24"}));
+        BigDecimal::Modulus big{BigDecimal{std::string(30, '9') + "7"}};
+        CHECK(big.powmod(123456789, BigDecimal{"1e20"} + 3) == BigDecimal{"9537910693845644368890414155556"});
+        CHECK(big.reduce(-7) == BigDecimal{std::string(30, '9') + "0"});
+        CHECK(BigDecimal::Modulus{1}.powmod(3, 0) == 0);
+        CHECK_THROWS_AS(prime.reduce(BigDecimal{"0.5"}), std::invalid_argument);
+        CHECK_THROWS_AS(prime.powmod(2, -1), std::invalid_argument);
+        CHECK_THROWS_AS(BigDecimal::Modulus{BigDecimal{"2.5"}}, std::invalid_argument);
     }
     TEST_CASE("%=") {
         BigDecimal bd{1000};
@@ -147,10 +874,33 @@ TEST_SUITE("Operators") {
         CHECK(bd-- == -5);
         CHECK(bd == -6);
     }
+    TEST_CASE("<=>") {
+        CHECK(BigDecimal{"1e-5"} > 0);
+        CHECK(BigDecimal{"-1e-5"} < 0);
+        CHECK(0 < BigDecimal{"1e-5"});
+        CHECK(BigDecimal{-5} >= -5);
+        CHECK(BigDecimal{-5} < -4);
+        //The leading digit's position can be past int's range at the exponent limits
+        CHECK(BigDecimal{"8.7e-14"} < BigDecimal{"1e2147483647"});
+        CHECK(BigDecimal{"-12e2147483647"} < BigDecimal{"-1e2147483647"});
+        CHECK(BigDecimal{"1e-2147483648"} < BigDecimal{"12e-2147483648"});
+    }
     TEST_CASE("<<") {
         std::stringstream ss{};
         ss << BigDecimal{"-50001e-2"};
         CHECK(ss.str() == "-500.01");
+        std::stringstream padded{};
+        padded << std::setw(9) << std::setfill('*') << BigDecimal{"1.5"};
+        CHECK(padded.str() == "******1.5");
+        std::stringstream flags{};
+        flags << std::showpos << std::left << std::setw(6) << BigDecimal{"1.5"} << '|';
+        CHECK(flags.str() == "+1.5  |");
+        std::stringstream large{};
+        large << BigDecimal{std::string(300, '7')};
+        CHECK(large.str() == std::string(300, '7'));
+        std::stringstream largePadded{};
+        largePadded << std::setw(700) << std::setfill('_') << BigDecimal{"-" + std::string(300, '7') + "e-150"};
+        CHECK(largePadded.str() == std::string(398, '_') + "-" + std::string(150, '7') + "." + std::string(150, '7'));
     }
     TEST_CASE(">>") {
         BigDecimal bd;
@@ -164,6 +914,32 @@ TEST_SUITE("Operators") {
         ss >> bd;
         CHECK(bd == 12345);
         CHECK_FALSE(ss.fail());
+        CHECK(ss.eof());
+
+        //Bad tokens set failbit rather than throwing, and are skipped over as a whole
+        std::stringstream bad{"1e99999999999 -.e5 1e+-2 0.00250e-1"};
+        CHECK_NOTHROW(bad >> bd);
+        CHECK(bad.fail());
+        bad.clear();
+        bad >> bd;
+        CHECK(bad.fail());
+        CHECK(bd == 0);
+        bad.clear();
+        bad >> bd;
+        CHECK(bad.fail());
+        bad.clear();
+        bad >> bd;
+        CHECK(bd.toString() == "2.5e-4");
+
+        //A width stops the read early, and only applies to the one read
+        std::stringstream wide{"123456 7.5e2"};
+        wide >> std::setw(3) >> bd;
+        CHECK(bd == 123);
+        CHECK(wide.width() == 0);
+        wide >> bd;
+        CHECK(bd == 456);
+        wide >> std::setw(4) >> bd;
+        CHECK(wide.fail());
     }
     //Non-assignment operators are all defined in terms of the assignment ones; if these fail, the corresponding assignment one should too
     TEST_CASE("+") {
@@ -181,9 +957,11 @@ TEST_SUITE("Operators") {
     TEST_CASE("/") {
         CHECK(BigDecimal{5} / 10 == BigDecimal{"0.5"});
         CHECK(1 / BigDecimal{"1e+5"} == 1e-5);
+        CHECK_THROWS_AS(BigDecimal{5} / 0, std::domain_error);
     }
     TEST_CASE("%") {
         CHECK(BigDecimal{56} % 11 == 1);
         CHECK(10 % BigDecimal{"7e-5"} == BigDecimal{"1e-5"});
+        CHECK_THROWS_AS(BigDecimal{5} % 0, std::domain_error);
     }
 }
\ No newline at end of file